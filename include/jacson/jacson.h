@@ -26,6 +26,7 @@ extern "C" {
 /**
  * Includes
  */
+#include <stddef.h>
 #include "jtypes.h"
 
 
@@ -38,6 +39,9 @@ extern "C" {
 #define JACSON_VERSION_PATCH 1
 #define JACSON_VERSION "0.2.1"
 
+// Returned by tape functions when there is no such value
+#define JCSN_TAPE_NONE ((size_t)-1)
+
 
 
 /**
@@ -48,23 +52,351 @@ extern "C" {
 typedef struct Jacson Jacson;
 
 
+// Flat representation of json data (See `JCSN_PARSE_TAPE`)
+typedef struct Jcsn_Tape Jcsn_Tape;
+
+
+// A query string parsed once to be run many times (See
+// `jcsn_query_compile`)
+typedef struct Jcsn_Query Jcsn_Query;
+
+
+// Many queries run together in one walk (See `jcsn_query_set_compile`)
+typedef struct Jcsn_QuerySet Jcsn_QuerySet;
+
+
+// A compiled JSONPath expression (See `jcsn_path_compile`)
+typedef struct Jcsn_Path Jcsn_Path;
+
+
+// Hash index of elements of a json array (See `jcsn_index_build`)
+typedef struct Jcsn_Index Jcsn_Index;
+
+
+// Parsing options. Combine them with `|` operator.
+enum Jcsn_Parse_Flag {
+    JCSN_PARSE_DEFAULT = 0,
+
+    // Unescape json strings in place inside the raw json data and
+    // null terminate them there. AST borrows every string from raw
+    // json data and no string is copied.
+    JCSN_PARSE_INSITU  = 1 << 0,
+
+    // Reject json data that is not valid utf-8
+    JCSN_PARSE_VALIDATE_UTF8 = 1 << 1,
+
+    // Build a flat tape instead of a tree of `Jcsn_JValue`. Read it with
+    // `jcsn_tape_*` functions. `jcsn_ast_root` and `jcsn_query_get`
+    // return NULL for such data.
+    JCSN_PARSE_TAPE = 1 << 2,
+
+    // Store json arrays of only integers or only reals as plain `long` or
+    // `double` arrays (8 bytes per element instead of 16). Read them with
+    // `jcsn_jarr_as_longs`/`jcsn_jarr_as_doubles` or element by element
+    // with `jcsn_jarr_type`, `jcsn_jarr_integer` and `jcsn_jarr_real`.
+    // Their elements are not `Jcsn_JValue`s, so `jcsn_jarr_get` and
+    // `jcsn_query_get` return NULL for them.
+    JCSN_PARSE_PACK_NUMBERS = 1 << 3,
+
+    // Parse nothing up front. Each `jcsn_query_get` walks raw json data
+    // along it's path, skips everything else by matching brackets and
+    // only parses the value it finds, so it's cost depends on bytes
+    // before that value, not on size of json data. Json data is only
+    // checked as far as it's walked. Returned values live until
+    // `jcsn_free`. `jcsn_ast_root` parses whole json data on first call.
+    // In-situ parsing is ignored in this mode.
+    JCSN_PARSE_ON_DEMAND = 1 << 4,
+};
+
+
 
 /**
  * Module Public API
  */
 
-// Parse raw json data
+// Thread safety.
+// Every function of this library is reentrant. Once parsing returns,
+// any number of threads may read the same `Jacson` (queries, json values
+// and tape) at the same time without locking. Parts of it that are
+// built on first use (hash indices of json objects, on-demand values and
+// AST) are published with atomic operations. Exceptions:
+//   - `jcsn_free` must not run while another thread uses `Jacson`.
+//   - a `Jcsn_JLookup` is written by `jcsn_jobj_get_cached`, so each
+//     thread needs it's own.
+// See test/stress.c.
+
+// Parse raw json data.
+// Json strings without escapes are not copied and point into `jdata`,
+// so `jdata` must outlive the returned value.
 Jacson *jcsn_parse_json(char *jdata);
 
+// Parse raw json data in-situ (destructive).
+// `jdata` is modified and must outlive the returned value.
+Jacson *jcsn_parse_json_insitu(char *jdata);
+
+// Parse raw json data with a combination of `Jcsn_Parse_Flag` values
+Jacson *jcsn_parse_json_flags(char *jdata, int flags);
+
+// Check that `len` bytes of `jdata` are valid json (RFC 8259) and valid
+// utf-8 without building an AST. Nothing is allocated and `jdata` does
+// not need to be null terminated. Objects/arrays nested deeper than
+// 1024 levels are rejected.
+// 0 -> invalid json data
+// 1 -> everything is ok
+int jcsn_validate_json(const char *jdata, size_t len);
+
 // Free all memory used by Jacson
 void jcsn_free(Jacson *j);
 
 // get root of AST
 Jcsn_JValue *jcsn_ast_root(Jacson *j);
 
-// get a json value from AST
+// get a json value from AST. If query ends in an aggregate function
+// (e.g. `values.sum()`), it's result is a new json value that lives until
+// `jcsn_free` (NULL if there is no result).
 Jcsn_JValue *jcsn_query_get(Jacson *j, const char *query);
 
+// Parse a query string once. Names in it are copied and hashed, indices
+// are converted to numbers. A compiled query is never modified, so it
+// can be run against any number of json values (NULL if query is empty
+// or out of memory).
+Jcsn_Query *jcsn_query_compile(const char *query);
+
+// get value of a compiled query, starting from `root`. It allocates
+// nothing and does no string parsing. Queries that end in an aggregate
+// function return NULL, since their result has nowhere to live.
+Jcsn_JValue *jcsn_query_exec(const Jcsn_Query *q, const Jcsn_JValue *root);
+
+// Free a compiled query
+void jcsn_query_free(Jcsn_Query *q);
+
+// Compile `n` queries into one set. Queries are merged by their common
+// prefixes, so each json object/array on the way to their values is
+// looked up once for all of them, not once per query (NULL if out of
+// memory or a query ends in a function). Empty queries never find a
+// value.
+Jcsn_QuerySet *jcsn_query_set_compile(const char *const *queries, size_t n);
+
+// get values of every query of a set, starting from `root`, in one walk.
+// `results` has room for one value per query, in order of queries
+// (NULL for a query that finds nothing). Returns number of values found.
+// It allocates nothing.
+size_t jcsn_query_set_exec(const Jcsn_QuerySet *qs, const Jcsn_JValue *root, Jcsn_JValue **results);
+
+// `jcsn_query_set_exec` on json data of `j`. In on-demand mode raw json
+// data is walked once for all queries and every json object/array on the
+// way is visited once. Walk stops as soon as every query has a value or
+// is known to have none.
+size_t jcsn_query_get_set(Jacson *j, const Jcsn_QuerySet *qs, Jcsn_JValue **results);
+
+// Free a query set
+void jcsn_query_set_free(Jcsn_QuerySet *qs);
+
+
+// JSONPath.
+// Unlike a query, a JSONPath may match any number of json values:
+//   $                   root (may be left out)
+//   .name ['name']      member of a json object
+//   [N]                 element of a json array (negative N counts from
+//                       it's end)
+//   .* [*]              every member/element
+//   [start:end:step]    elements of a slice of a json array. Any part may
+//                       be left out and step may be negative.
+//   ..name ..[...]      that selector on a value and all of it's
+//                       descendants
+//   [?(@.a.b OP lit)]   members/elements whose relative path `@.a.b`
+//                       compares to `lit` (a number, a quoted string,
+//                       true, false or null) by OP (== != < <= > >=).
+//                       Without `OP lit` relative path must exist.
+//                       If it does not, only `!=` is true.
+// e.g. `$.items[?(@.qty > 0)].price`. Elements of packed json arrays are
+// never matched (See `JCSN_PARSE_PACK_NUMBERS`).
+
+// Compile a JSONPath (NULL if it's invalid or out of memory). A compiled
+// JSONPath is never modified, so it can be evaluated by many threads.
+Jcsn_Path *jcsn_path_compile(const char *path);
+
+// Start evaluating `path` on `root`. An iterator allocates nothing and
+// no result is collected: `jcsn_path_next` walks json data until it finds
+// next match. Matches of a selector come in order of json data. For `..`
+// they come in RFC 9535 descendant order: every match of selector on a
+// value, then matches under it's first child, then under it's second
+// child and so on. So `$..a` on `{"x": {"a": 1}, "a": 2}` gets 2, then 1.
+void jcsn_path_iter(Jcsn_PathIter *it, const Jcsn_Path *path, const Jcsn_JValue *root);
+
+// get next value matched by JSONPath (NULL when there is no more)
+Jcsn_JValue *jcsn_path_next(Jcsn_PathIter *it);
+
+// Free a compiled JSONPath
+void jcsn_path_free(Jcsn_Path *path);
+
+
+// Json values.
+// Every function below is O(1), except `jcsn_jobj_get`. Functions of a
+// json array/object return 0 or NULL when value has another type or
+// `idx` is out of range.
+
+// get number of elements of a json array
+size_t jcsn_jarr_len(const Jcsn_JValue *arr);
+
+// get element at `idx` of a json array (NULL for packed arrays, See
+// `JCSN_PARSE_PACK_NUMBERS`)
+Jcsn_JValue *jcsn_jarr_get(const Jcsn_JValue *arr, size_t idx);
+
+// get type of element at `idx` of a json array (J_NULL if out of range)
+enum Jcsn_JVal_T jcsn_jarr_type(const Jcsn_JValue *arr, size_t idx);
+
+// get integer/real element at `idx` of a json array (0 if element has
+// another type)
+long jcsn_jarr_integer(const Jcsn_JValue *arr, size_t idx);
+
+double jcsn_jarr_real(const Jcsn_JValue *arr, size_t idx);
+
+// get elements of a packed json array as one contiguous array of
+// `jcsn_jarr_len(arr)` numbers. NULL if `arr` is not packed or has
+// elements of another type.
+const long *jcsn_jarr_as_longs(const Jcsn_JValue *arr);
+
+const double *jcsn_jarr_as_doubles(const Jcsn_JValue *arr);
+
+// get number of members of a json object
+size_t jcsn_jobj_len(const Jcsn_JValue *obj);
+
+// get name of member at `idx` of a json object
+Jcsn_JString jcsn_jobj_name(const Jcsn_JValue *obj, size_t idx);
+
+// get value of member at `idx` of a json object
+Jcsn_JValue *jcsn_jobj_value(const Jcsn_JValue *obj, size_t idx);
+
+// get value of first member of a json object named `name` (`len` bytes)
+Jcsn_JValue *jcsn_jobj_get(const Jcsn_JValue *obj, const char *name, size_t len);
+
+// Json objects with the same member names in the same order (e.g.
+// records in a json array) share one copy of those names. A lookup on
+// such an object is remembered in `cache` and repeating it on another
+// object of the same shape just reads the value at that position, or
+// returns NULL at once if that shape lacks the member. A cache holds one
+// name (compared by address and length): looking up another name with
+// it starts over. A cache must not outlive json data it was used with.
+Jcsn_JValue *jcsn_jobj_get_cached(const Jcsn_JValue *obj,
+                                  const char *name,
+                                  size_t len,
+                                  Jcsn_JLookup *cache);
+
+// Member names of json objects are interned: equal names in json data
+// share one address. `jcsn_intern` gets that address for `name` (`data`
+// is NULL if no json object has a member named so). Such a name can be
+// looked up with `jcsn_jobj_get_interned`, which compares addresses of
+// names instead of their bytes.
+Jcsn_JString jcsn_intern(Jacson *j, const char *name, size_t len);
+
+Jcsn_JValue *jcsn_jobj_get_interned(const Jcsn_JValue *obj, Jcsn_JString name);
+
+// get a json string (`data` is NULL if value is not a json string)
+Jcsn_JString jcsn_jval_string(const Jcsn_JValue *str);
+
+
+// Aggregates.
+// Reduce numbers of a json array in one pass, skipping elements of other
+// types. Packed json arrays (See `JCSN_PARSE_PACK_NUMBERS`) are reduced by
+// branch free loops over their `long`/`double` elements that compilers
+// vectorize. Integers are summed exactly, without overflowing.
+// A query string may end in one of these functions on a json array:
+// `count()` (of numbers), `sum()`, `min()`, `max()` and `mean()` (or
+// `avg()`), e.g. `metrics.values.sum()` (See `jcsn_query_get`).
+
+// get count, sum, min and max of numbers of a json array
+Jcsn_JStats jcsn_jarr_stats(const Jcsn_JValue *arr);
+
+// get sum of numbers of a json array (0 if there is none)
+double jcsn_jarr_sum(const Jcsn_JValue *arr);
+
+// get smallest and largest number of a json array (false if there is
+// none). `min` or `max` may be NULL.
+bool jcsn_jarr_minmax(const Jcsn_JValue *arr, double *min, double *max);
+
+
+// Columns.
+// Turn a json array of records (json objects) into one column per member
+// in a single walk over it. Members of records of the same shape are
+// found without comparing names (See `jcsn_jobj_get_cached`). A record
+// without a member, or with a value of another type, is null in that
+// column. Elements that are not json objects are nulls in every column.
+
+// Fill `n` columns from json array `arr`. `name` and `type` of each
+// column must be set.
+// 0 -> ok
+// 1 -> `arr` is not a json array or out of memory (nothing is allocated)
+int jcsn_extract_columns(const Jcsn_JValue *arr, Jcsn_Column *cols, size_t n);
+
+// Free buffers of `n` columns
+void jcsn_columns_free(Jcsn_Column *cols, size_t n);
+
+
+// Indices.
+// An index maps value of member `name` of json objects in a json array
+// (e.g. `id`) to the element that has it, so finding an element by it is
+// O(1) instead of a scan. Json integers and strings are keys, elements
+// with a key of another type or without one are not indexed. If many
+// elements have the same key, the first one is found. An index is never
+// modified, so many threads can use it at the same time. It must not
+// outlive json data it was built on.
+
+// Build an index of json array `arr` on member `name` in one walk (NULL
+// if `arr` is not a json array or out of memory)
+Jcsn_Index *jcsn_index_build(const Jcsn_JValue *arr, const char *name);
+
+// get element whose key equals `key`, a json integer or string (e.g. a
+// value of another json document, to join them). NULL if there is none.
+Jcsn_JValue *jcsn_index_lookup(const Jcsn_Index *idx, const Jcsn_JValue *key);
+
+Jcsn_JValue *jcsn_index_lookup_integer(const Jcsn_Index *idx, long key);
+
+Jcsn_JValue *jcsn_index_lookup_string(const Jcsn_Index *idx, const char *key, size_t len);
+
+// get number of distinct keys of an index
+size_t jcsn_index_len(const Jcsn_Index *idx);
+
+// Free an index
+void jcsn_index_free(Jcsn_Index *idx);
+
+
+// Tape DOM.
+// A value on tape is identified by it's index. Every function below is
+// O(1). Children of a json object are it's member names, each one
+// followed by it's value, so next sibling of a name is it's value.
+// Index may be `JCSN_TAPE_NONE` (e.g. returned at end of a list): type
+// of it is J_NULL, it has no child, sibling or end, and it's string,
+// integer, real and bool are NULL, 0, 0.0 and false.
+
+// get tape of json data parsed with `JCSN_PARSE_TAPE` (NULL otherwise)
+const Jcsn_Tape *jcsn_tape(Jacson *j);
+
+// get index of root value
+size_t jcsn_tape_root(const Jcsn_Tape *t);
+
+// get type of value at `idx`
+enum Jcsn_JVal_T jcsn_tape_type(const Jcsn_Tape *t, size_t idx);
+
+// get first child of json object/array at `idx`
+size_t jcsn_tape_child(const Jcsn_Tape *t, size_t idx);
+
+// get next sibling of value at `idx` in it's json object/array
+size_t jcsn_tape_next(const Jcsn_Tape *t, size_t idx);
+
+// get index right after value at `idx` and all of it's children
+size_t jcsn_tape_skip(const Jcsn_Tape *t, size_t idx);
+
+// get json string at `idx`. Returned string is null terminated and
+// it's length is stored in `len` (if not NULL).
+const char *jcsn_tape_string(const Jcsn_Tape *t, size_t idx, size_t *len);
+
+long jcsn_tape_integer(const Jcsn_Tape *t, size_t idx);
+
+double jcsn_tape_real(const Jcsn_Tape *t, size_t idx);
+
+bool jcsn_tape_bool(const Jcsn_Tape *t, size_t idx);
+
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,7 @@ extern "C" {
 #endif // __cplusplus
 
 #include <stdbool.h>
+#include <stdint.h>
 
 
 /**
@@ -40,48 +41,143 @@ enum Jcsn_JVal_T {
     J_NULL,
 };
 
-struct Jcsn_JArray {
-    struct Jcsn_JValue *vals;
+// A json string is not null terminated. `data` points either into the raw
+// json data (if string has no escapes) or to an unescaped copy of it.
+struct Jcsn_JString {
+    char *data;
     unsigned long len;
-    unsigned long cap;
-};
-
-struct Jcsn_JObject {
-    struct Jcsn_JValue *values;
-    char **names;
-    unsigned long len;
-    unsigned long cap;
 };
 
+// Every json value is a node in a pool of nodes owned by it's document.
+// Nodes never point to each other: children of a json object/array are
+// stored next to each other in the pool and are found by an offset
+// relative to their parent node. So the pool is one relocatable block.
+//
+// Only `type` and scalar values (`real`, `integer` and `boolean`) are
+// meant to be read directly. Use `jcsn_jarr_*`, `jcsn_jobj_*` and
+// `jcsn_jval_string` functions for everything else.
 typedef struct Jcsn_JValue {
-    //bool parsed;
+    // enum Jcsn_JVal_T
+    unsigned char type;
 
-    enum Jcsn_JVal_T type;
+    // Internal flags
+    unsigned char flags;
+    unsigned short reserved;
 
-    // Any json value is part of a json object or a json array.
-    // `parent` is a pointer to the json object or json array
-    // that this value belongs to.
-    struct Jcsn_JValue *parent;
+    // Number of elements of a json array, members of a json object or
+    // bytes of a json string
+    uint32_t len;
 
     union {
-        struct Jcsn_JArray array;
-        struct Jcsn_JObject object;
-        char *string;
         double real;
         long integer;
         bool boolean;
+
+        // json string in raw json data
+        char *str;
+
+        // json string in the pool, in bytes from this node
+        int64_t off;
+
+        // First member name and first value of a json object/array,
+        // in nodes from this node
+        struct {
+            int32_t names;
+            int32_t vals;
+        } kids;
     } data;
 } Jcsn_JValue;
 
 
-typedef struct Jcsn_JArray Jcsn_JArray;
+typedef struct Jcsn_JString Jcsn_JString;
+
 
+// Result of a member name lookup, reused for json objects of the same
+// shape (See `jcsn_jobj_get_cached`). Zero initialize it.
+typedef struct Jcsn_JLookup {
+    const Jcsn_JValue *names;
+    unsigned long idx;
 
-// Json object is just a map between strings and Json values.
-// So I defined a json object as a dynamic array that each member
-// of `names` field is mapped to exact same index in `values` field.
-// In this form, we created a map from strings to value they refer to.
-typedef struct Jcsn_JObject Jcsn_JObject;
+    // Name it was filled for
+    const char *name;
+    unsigned long len;
+} Jcsn_JLookup;
+
+
+// Reduction of numbers of a json array (See `jcsn_jarr_stats`). Elements
+// of other types are skipped.
+typedef struct Jcsn_JStats {
+    // Number of integer and real elements, and how many of them are reals
+    unsigned long count;
+    unsigned long reals;
+
+    // Sum of every number. Sum of integers is also kept exactly in `isum`
+    // unless it does not fit a long (`overflow`).
+    double sum;
+    long isum;
+    bool overflow;
+
+    // Smallest and largest number, and smallest and largest integer (0 if
+    // there is none)
+    double min;
+    double max;
+    long imin;
+    long imax;
+} Jcsn_JStats;
+
+
+// Type of a column (See `jcsn_extract_columns`)
+enum Jcsn_Col_T {
+    JCSN_COL_INT64,  // json integers as `int64_t`
+    JCSN_COL_DOUBLE, // json integers and reals as `double`
+    JCSN_COL_BOOL,   // json booleans as bits
+    JCSN_COL_STRING, // json strings as `int32_t` offsets into bytes
+};
+
+
+// A column of values of one member of json objects in a json array. Set
+// `name` and `type`, everything else is filled by `jcsn_extract_columns`.
+// Buffers are laid out as in Apache Arrow columnar format, so they can be
+// handed to Arrow as they are.
+typedef struct Jcsn_Column {
+    const char *name;
+    enum Jcsn_Col_T type;
+
+    // Number of rows (elements of json array) and rows with no value
+    unsigned long len;
+    unsigned long null_count;
+
+    // Bit `i % 8` of byte `i / 8` is set if row `i` has a value
+    uint8_t *validity;
+
+    // JCSN_COL_INT64: `int64_t[len]`
+    // JCSN_COL_DOUBLE: `double[len]`
+    // JCSN_COL_BOOL: bits, like `validity`
+    // JCSN_COL_STRING: `int32_t[len + 1]`, row `i` is bytes from
+    // `offsets[i]` to `offsets[i + 1]` of `data`
+    // Rows with no value are zero (or empty strings).
+    void *values;
+
+    // JCSN_COL_STRING: bytes of every string, back to back
+    char *data;
+} Jcsn_Column;
+
+
+// Json data is nested at most 1024 levels deep. An iterator needs one
+// frame per level, plus one for root and one for a result.
+#define JCSN_PATH_MAX_FRAMES (1024 + 2)
+
+// State of a JSONPath evaluation (See `jcsn_path_iter`). It allocates
+// nothing, so it can live on the stack. Fields are internal.
+typedef struct Jcsn_PathIter {
+    const struct Jcsn_Path *path;
+    unsigned long depth;
+    struct {
+        const Jcsn_JValue *val;
+        uint32_t pos;
+        uint32_t step;
+    } frames[JCSN_PATH_MAX_FRAMES];
+} Jcsn_PathIter;
 
 
 
@@ -0,0 +1,296 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Aggregate Module
+ * Reductions (count, sum, min, max, mean) over numbers of a json array
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <math.h>
+
+// Jacson
+#include "aggregate.h"
+#include <jacson/jacson.h>
+
+
+
+/**
+ * Macros and constants
+ */
+
+// Independent accumulators of the real kernel. Sums of floating point
+// numbers are not reassociated by compilers, so lanes are spelled out
+// to let them be vectorized.
+#define JCSN_AGG_LANES 4
+
+
+
+/**
+ * Types
+ */
+
+// Partial reduction of a json array. Integers and reals are reduced
+// separately. Each integer is summed in two halves: it's high 32 bits
+// (signed) into `hi` and it's low 32 bits (unsigned) into `lo`. Neither
+// can overflow for less than 2^32 elements, so loops have no overflow
+// checks and only the final sum is checked.
+typedef struct Jcsn_Agg {
+    size_t ints;
+    int64_t hi;
+    uint64_t lo;
+    long imin;
+    long imax;
+
+    size_t reals;
+    double sum;
+    double min;
+    double max;
+} Jcsn_Agg;
+
+
+
+/**
+ * Module Private API
+ */
+
+static void jcsn_agg_longs(Jcsn_Agg *a, const long *v, size_t n) {
+    int64_t hi = 0;
+    uint64_t lo = 0;
+    long mn = a->imin, mx = a->imax;
+
+    for (size_t i = 0; i < n; i++) {
+        hi += (int64_t)v[i] >> 32;
+        lo += (uint32_t)v[i];
+        mn = (v[i] < mn) ? v[i] : mn;
+        mx = (v[i] > mx) ? v[i] : mx;
+    }
+
+    a->ints += n;
+    a->hi += hi;
+    a->lo += lo;
+    a->imin = mn;
+    a->imax = mx;
+}
+
+
+static void jcsn_agg_doubles(Jcsn_Agg *a, const double *v, size_t n) {
+    double sum[JCSN_AGG_LANES], mn[JCSN_AGG_LANES], mx[JCSN_AGG_LANES];
+    size_t i = 0, k;
+
+    for (k = 0; k < JCSN_AGG_LANES; k++) {
+        sum[k] = 0;
+        mn[k] = a->min;
+        mx[k] = a->max;
+    }
+
+    for (; i + JCSN_AGG_LANES <= n; i += JCSN_AGG_LANES) {
+        for (k = 0; k < JCSN_AGG_LANES; k++) {
+            sum[k] += v[i + k];
+            mn[k] = (v[i + k] < mn[k]) ? v[i + k] : mn[k];
+            mx[k] = (v[i + k] > mx[k]) ? v[i + k] : mx[k];
+        }
+    }
+    for (; i < n; i++) {
+        sum[0] += v[i];
+        mn[0] = (v[i] < mn[0]) ? v[i] : mn[0];
+        mx[0] = (v[i] > mx[0]) ? v[i] : mx[0];
+    }
+
+    for (k = 0; k < JCSN_AGG_LANES; k++) {
+        a->sum += sum[k];
+        a->min = (mn[k] < a->min) ? mn[k] : a->min;
+        a->max = (mx[k] > a->max) ? mx[k] : a->max;
+    }
+    a->reals += n;
+}
+
+
+// Elements of a json array that is not packed are nodes of any type.
+// One pass reduces both integers and reals and skips everything else.
+static void jcsn_agg_nodes(Jcsn_Agg *a, const Jcsn_JValue *v, size_t n) {
+    int64_t hi = 0;
+    uint64_t lo = 0;
+    long mn = a->imin, mx = a->imax, x;
+    double sum = 0, rmn = a->min, rmx = a->max, d;
+    size_t ints = 0, reals = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (v[i].type == J_INTEGER) {
+            x = v[i].data.integer;
+            hi += (int64_t)x >> 32;
+            lo += (uint32_t)x;
+            mn = (x < mn) ? x : mn;
+            mx = (x > mx) ? x : mx;
+            ints += 1;
+        } else if (v[i].type == J_REAL) {
+            d = v[i].data.real;
+            sum += d;
+            rmn = (d < rmn) ? d : rmn;
+            rmx = (d > rmx) ? d : rmx;
+            reals += 1;
+        }
+    }
+
+    a->ints += ints;
+    a->hi += hi;
+    a->lo += lo;
+    a->imin = mn;
+    a->imax = mx;
+    a->reals += reals;
+    a->sum += sum;
+    a->min = rmn;
+    a->max = rmx;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+Jcsn_JStats jcsn_jarr_stats(const Jcsn_JValue *arr) {
+    Jcsn_JStats st = { 0 };
+    Jcsn_Agg a = {
+        .imin = LONG_MAX,
+        .imax = LONG_MIN,
+        .min = HUGE_VAL,
+        .max = -HUGE_VAL,
+    };
+    int64_t hi, isum;
+    uint32_t lo;
+    size_t n = jcsn_jarr_len(arr);
+
+    if (n == 0)
+        return st;
+
+    if (jcsn_jarr_as_longs(arr))
+        jcsn_agg_longs(&a, jcsn_jarr_as_longs(arr), n);
+    else if (jcsn_jarr_as_doubles(arr))
+        jcsn_agg_doubles(&a, jcsn_jarr_as_doubles(arr), n);
+    else
+        jcsn_agg_nodes(&a, jcsn_jarr_get(arr, 0), n);
+
+    // sum of integers is `hi * 2^32 + lo`
+    hi = a.hi + (int64_t)(a.lo >> 32);
+    lo = (uint32_t)a.lo;
+    st.overflow = (hi < INT32_MIN || hi > INT32_MAX);
+    if (!st.overflow) {
+        isum = hi * ((int64_t)1 << 32) + lo;
+        st.overflow = (isum < LONG_MIN || isum > LONG_MAX);
+        st.isum = (st.overflow) ? 0 : (long)isum;
+    }
+
+    st.count = (unsigned long)(a.ints + a.reals);
+    st.reals = (unsigned long)a.reals;
+    st.sum = (double)hi * 4294967296.0 + (double)lo + a.sum;
+    if (a.ints) {
+        st.imin = a.imin;
+        st.imax = a.imax;
+    }
+    if (st.count) {
+        st.min = (a.ints && (double)a.imin < a.min) ? (double)a.imin : a.min;
+        st.max = (a.ints && (double)a.imax > a.max) ? (double)a.imax : a.max;
+    }
+    return st;
+}
+
+
+double jcsn_jarr_sum(const Jcsn_JValue *arr) {
+    return jcsn_jarr_stats(arr).sum;
+}
+
+
+bool jcsn_jarr_minmax(const Jcsn_JValue *arr, double *min, double *max) {
+    Jcsn_JStats st = jcsn_jarr_stats(arr);
+    if (min)
+        *min = st.min;
+    if (max)
+        *max = st.max;
+    return st.count > 0;
+}
+
+
+enum Jcsn_Agg_Fn jcsn_agg_function(const char *name, size_t len) {
+    static const struct { const char *name; enum Jcsn_Agg_Fn fn; } fns[] = {
+        { "count", AGG_COUNT }, { "sum", AGG_SUM }, { "min", AGG_MIN },
+        { "max", AGG_MAX }, { "mean", AGG_MEAN }, { "avg", AGG_MEAN },
+    };
+
+    for (size_t i = 0; i < sizeof(fns) / sizeof(fns[0]); i++) {
+        if (strlen(fns[i].name) == len && memcmp(fns[i].name, name, len) == 0)
+            return fns[i].fn;
+    }
+    return AGG_NONE;
+}
+
+
+int jcsn_agg_apply(enum Jcsn_Agg_Fn fn, const Jcsn_JValue *arr, Jcsn_JValue *result) {
+    Jcsn_JStats st;
+    if (arr->type != J_ARRAY)
+        return 1;
+
+    st = jcsn_jarr_stats(arr);
+    if (st.count == 0 && fn != AGG_COUNT && fn != AGG_SUM)
+        return 1;
+
+    // integer results stay integers as long as they are exact
+    *result = (Jcsn_JValue) { .type = J_INTEGER };
+    switch (fn) {
+    case AGG_COUNT:
+        result->data.integer = (long)st.count;
+        break;
+    case AGG_SUM:
+        if (st.reals || st.overflow) {
+            result->type = J_REAL;
+            result->data.real = st.sum;
+        } else {
+            result->data.integer = st.isum;
+        }
+        break;
+    case AGG_MIN:
+    case AGG_MAX:
+        if (st.reals) {
+            result->type = J_REAL;
+            result->data.real = (fn == AGG_MIN) ? st.min : st.max;
+        } else {
+            result->data.integer = (fn == AGG_MIN) ? st.imin : st.imax;
+        }
+        break;
+    case AGG_MEAN:
+        result->type = J_REAL;
+        result->data.real = st.sum / (double)st.count;
+        break;
+    default:
+        return 1;
+    }
+    return 0;
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,65 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Aggregate Module
+ * Reductions (count, sum, min, max, mean) over numbers of a json array
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_AGGREGATE_H
+#define __JACSON_AGGREGATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <jacson/jtypes.h>
+
+
+
+/**
+ * Types
+ */
+
+// A function at the end of a query string (e.g. `values.sum()`)
+enum Jcsn_Agg_Fn {
+    AGG_NONE,
+    AGG_COUNT,
+    AGG_SUM,
+    AGG_MIN,
+    AGG_MAX,
+    AGG_MEAN,
+};
+
+
+
+/**
+ * Module Public API
+ */
+
+// Get function named `name` (`len` bytes, without `()`). AGG_NONE if
+// there is no such function.
+enum Jcsn_Agg_Fn jcsn_agg_function(const char *name, size_t len);
+
+// Apply `fn` to json array `arr` and store result in `result`.
+// 0 -> ok
+// 1 -> no result (`arr` is not a json array or min/max/mean of no numbers)
+int jcsn_agg_apply(enum Jcsn_Agg_Fn fn, const Jcsn_JValue *arr, Jcsn_JValue *result);
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_AGGREGATE_H
@@ -0,0 +1,85 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Atomics
+ * The few atomic operations that keep lazy parts of parsed json
+ * data safe to read from many threads
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_ATOMIC_H
+#define __JACSON_ATOMIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+
+
+/**
+ * Macros
+ */
+
+// Loads are acquire, stores are release and a compare-and-swap is both.
+// `jcsn_atomic_cas_*` sets `*p` to `desired` if it equals `*expected`
+// and returns 1. Otherwise it stores `*p` in `*expected` and returns 0.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static __inline unsigned char jcsn_atomic_load_u8(unsigned char *p) {
+    return (unsigned char)_InterlockedOr8((volatile char*)p, 0);
+}
+
+static __inline void jcsn_atomic_store_u8(unsigned char *p, unsigned char v) {
+    (void)_InterlockedExchange8((volatile char*)p, (char)v);
+}
+
+static __inline int jcsn_atomic_cas_u8(unsigned char *p, unsigned char *expected, unsigned char desired) {
+    unsigned char old = (unsigned char)_InterlockedCompareExchange8((volatile char*)p, (char)desired, (char)*expected);
+    if (old == *expected)
+        return 1;
+    *expected = old;
+    return 0;
+}
+
+static __inline void *jcsn_atomic_load_ptr(void **p) {
+    return _InterlockedCompareExchangePointer(p, NULL, NULL);
+}
+
+static __inline int jcsn_atomic_cas_ptr(void **p, void **expected, void *desired) {
+    void *old = _InterlockedCompareExchangePointer(p, desired, *expected);
+    if (old == *expected)
+        return 1;
+    *expected = old;
+    return 0;
+}
+#else
+    #define jcsn_atomic_load_u8(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define jcsn_atomic_store_u8(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+    #define jcsn_atomic_cas_u8(p, expected, desired) \
+        __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+    #define jcsn_atomic_load_ptr(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define jcsn_atomic_cas_ptr(p, expected, desired) \
+        __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif // _MSC_VER
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_ATOMIC_H
@@ -0,0 +1,237 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Column Module
+ * Extract members of json objects in a json array into columns
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Jacson
+#include "log.h"
+#include "mem.h"
+#include <jacson/jacson.h>
+
+
+
+/**
+ * Macros and constants
+ */
+
+// First capacity of bytes of a string column
+#define JCSN_COLUMN_DATA_CAP 256
+
+
+
+/**
+ * Types
+ */
+
+// State of filling a column
+typedef struct Jcsn_ColState {
+    size_t name_len;
+
+    // Member names of records of the same shape are looked up once
+    Jcsn_JLookup lookup;
+
+    // Used and allocated bytes of a string column
+    size_t used;
+    size_t cap;
+} Jcsn_ColState;
+
+
+
+/**
+ * Module Private API
+ */
+
+static size_t jcsn_column_value_size(enum Jcsn_Col_T type, size_t rows) {
+    switch (type) {
+    case JCSN_COL_INT64:  return sizeof(int64_t) * rows;
+    case JCSN_COL_DOUBLE: return sizeof(double) * rows;
+    case JCSN_COL_BOOL:   return (rows + 7) / 8;
+    case JCSN_COL_STRING: return sizeof(int32_t) * (rows + 1);
+    }
+    return 0;
+}
+
+
+// Allocate zeroed buffers of a column of `rows` rows
+// 0 -> ok
+// 1 -> out of memory
+static int jcsn_column_init(Jcsn_Column *col, Jcsn_ColState *st, size_t rows) {
+    size_t size = jcsn_column_value_size(col->type, rows);
+
+    col->len = (unsigned long)rows;
+    col->null_count = 0;
+    col->validity = calloc((rows) ? (rows + 7) / 8 : 1, 1);
+    col->values = calloc((size) ? size : 1, 1);
+    col->data = NULL;
+    if (!col->validity || !col->values)
+        return 1;
+
+    *st = (Jcsn_ColState) { .name_len = strlen(col->name) };
+    if (col->type == JCSN_COL_STRING) {
+        st->cap = JCSN_COLUMN_DATA_CAP;
+        col->data = malloc(st->cap);
+        if (!col->data)
+            return 1;
+    }
+    return 0;
+}
+
+
+// Append bytes of a json string to a string column
+// 0 -> ok
+// 1 -> out of memory or more than 2^31 - 1 bytes (offsets are 32 bits)
+static int jcsn_column_append(Jcsn_Column *col, Jcsn_ColState *st, Jcsn_JString s) {
+    size_t cap = st->cap;
+    char *tmp;
+
+    if (s.len > (size_t)INT32_MAX - st->used)
+        return 1;
+
+    while (st->used + s.len > cap)
+        cap *= 2;
+    if (cap != st->cap) {
+        tmp = realloc(col->data, cap);
+        if (!tmp)
+            return 1;
+        col->data = tmp;
+        st->cap = cap;
+    }
+
+    memcpy(col->data + st->used, s.data, s.len);
+    st->used += s.len;
+    return 0;
+}
+
+
+// Store `val` at `row` of a column. Missing values and values of another
+// type are nulls, except that integers fill double columns too.
+// 0 -> ok
+// 1 -> out of memory
+static int jcsn_column_put(Jcsn_Column *col, Jcsn_ColState *st, size_t row, const Jcsn_JValue *val) {
+    bool valid = false;
+
+    if (val) {
+        switch (col->type) {
+        case JCSN_COL_INT64:
+            valid = (val->type == J_INTEGER);
+            if (valid)
+                ((int64_t*)col->values)[row] = val->data.integer;
+            break;
+        case JCSN_COL_DOUBLE:
+            valid = (val->type == J_INTEGER || val->type == J_REAL);
+            if (valid)
+                ((double*)col->values)[row] = (val->type == J_REAL) ? val->data.real : (double)val->data.integer;
+            break;
+        case JCSN_COL_BOOL:
+            valid = (val->type == J_BOOL);
+            if (valid && val->data.boolean)
+                ((uint8_t*)col->values)[row / 8] |= (uint8_t)(1 << (row % 8));
+            break;
+        case JCSN_COL_STRING:
+            valid = (val->type == J_STRING);
+            if (valid && jcsn_column_append(col, st, jcsn_jval_string(val)))
+                return 1;
+            break;
+        }
+    }
+
+    // a null string is an empty slot
+    if (col->type == JCSN_COL_STRING)
+        ((int32_t*)col->values)[row + 1] = (int32_t)st->used;
+
+    if (valid)
+        col->validity[row / 8] |= (uint8_t)(1 << (row % 8));
+    else
+        col->null_count += 1;
+    return 0;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+int jcsn_extract_columns(const Jcsn_JValue *arr, Jcsn_Column *cols, size_t n) {
+    Jcsn_ColState *states = NULL;
+    const Jcsn_JValue *rec, *val;
+    size_t rows, c;
+
+    for (c = 0; c < n; c++) {
+        cols[c].validity = NULL;
+        cols[c].values = NULL;
+        cols[c].data = NULL;
+    }
+    if (arr->type != J_ARRAY)
+        return 1;
+
+    rows = jcsn_jarr_len(arr);
+    states = malloc(sizeof(*states) * ((n) ? n : 1));
+    if (!states)
+        goto err;
+    for (c = 0; c < n; c++) {
+        if (jcsn_column_init(&cols[c], &states[c], rows))
+            goto err;
+    }
+
+    // rows are the outer loop, so each record is read once
+    for (size_t r = 0; r < rows; r++) {
+        rec = jcsn_jarr_get(arr, r);
+        for (c = 0; c < n; c++) {
+            val = (rec) ? jcsn_jobj_get_cached(rec, cols[c].name, states[c].name_len, &states[c].lookup) : NULL;
+            if (jcsn_column_put(&cols[c], &states[c], r, val))
+                goto err;
+        }
+    }
+
+    xfree(states);
+    return 0;
+
+err:
+    JCSN_LOG_ERR("Failed to extract columns\n", NULL);
+    xfree(states);
+    jcsn_columns_free(cols, n);
+    return 1;
+}
+
+
+void jcsn_columns_free(Jcsn_Column *cols, size_t n) {
+    for (size_t c = 0; c < n; c++) {
+        xfree(cols[c].validity);
+        xfree(cols[c].values);
+        xfree(cols[c].data);
+    }
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
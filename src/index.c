@@ -0,0 +1,215 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Index Module
+ * Hash index of elements of a json array by value of a member
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Jacson
+#include "log.h"
+#include "str.h"
+#include "mem.h"
+#include <jacson/jacson.h>
+
+
+
+/**
+ * Types
+ */
+
+// A slot of an index (`key` is NULL for an empty slot). Hash is compared
+// before the key itself.
+typedef struct Jcsn_Index_Slot {
+    const Jcsn_JValue *key;
+    uint32_t hash;
+
+    // Index of element in json array
+    uint32_t row;
+} Jcsn_Index_Slot;
+
+
+// Open addressing hash table with linear probing. It's never modified
+// after `jcsn_index_build`.
+struct Jcsn_Index {
+    const Jcsn_JValue *arr;
+    size_t len;
+    size_t mask;
+    Jcsn_Index_Slot slots[];
+};
+
+
+
+/**
+ * Module Private API
+ */
+
+// Fibonacci hashing, high bits of product are well mixed
+static uint32_t jcsn_index_hash_long(long v) {
+    return (uint32_t)(((uint64_t)v * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+}
+
+
+// Get hash of a key
+// 0 -> ok
+// 1 -> value can't be a key (only json integers and strings are keys)
+static int jcsn_index_hash(const Jcsn_JValue *key, uint32_t *hash) {
+    Jcsn_JString s;
+
+    if (key->type == J_INTEGER) {
+        *hash = jcsn_index_hash_long(key->data.integer);
+        return 0;
+    }
+    if (key->type == J_STRING) {
+        s = jcsn_jval_string(key);
+        *hash = jcsn_string_hash(s.data, s.len);
+        return 0;
+    }
+    return 1;
+}
+
+
+static bool jcsn_index_key_equal(const Jcsn_JValue *a, const Jcsn_JValue *b) {
+    Jcsn_JString sa, sb;
+
+    if (a->type != b->type)
+        return false;
+    if (a->type == J_INTEGER)
+        return a->data.integer == b->data.integer;
+
+    sa = jcsn_jval_string(a);
+    sb = jcsn_jval_string(b);
+    return sa.len == sb.len && memcmp(sa.data, sb.data, sa.len) == 0;
+}
+
+
+// Find slot of `key` or the empty slot where it would be
+static const Jcsn_Index_Slot *jcsn_index_slot(const Jcsn_Index *idx, const Jcsn_JValue *key, uint32_t hash) {
+    const Jcsn_Index_Slot *slot;
+
+    for (size_t i = hash & idx->mask;; i = (i + 1) & idx->mask) {
+        slot = &idx->slots[i];
+        if (!slot->key || (slot->hash == hash && jcsn_index_key_equal(slot->key, key)))
+            return slot;
+    }
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+Jcsn_Index *jcsn_index_build(const Jcsn_JValue *arr, const char *name) {
+    Jcsn_JLookup lookup = { 0 };
+    const Jcsn_JValue *rec, *key;
+    Jcsn_Index_Slot *slot;
+    Jcsn_Index *idx;
+    size_t rows, cap = 8, len;
+    uint32_t hash;
+
+    if (arr->type != J_ARRAY)
+        return NULL;
+
+    // at most half full
+    rows = jcsn_jarr_len(arr);
+    while (cap < rows * 2)
+        cap *= 2;
+
+    idx = calloc(1, sizeof(*idx) + sizeof(Jcsn_Index_Slot) * cap);
+    if (!idx) {
+        JCSN_LOG_ERR("Failed to allocate memory for index\n", NULL);
+        return NULL;
+    }
+    idx->arr = arr;
+    idx->mask = cap - 1;
+
+    len = strlen(name);
+    for (size_t r = 0; r < rows; r++) {
+        rec = jcsn_jarr_get(arr, r);
+        key = (rec) ? jcsn_jobj_get_cached(rec, name, len, &lookup) : NULL;
+        if (!key || jcsn_index_hash(key, &hash))
+            continue;
+
+        // first element with a key wins
+        slot = (Jcsn_Index_Slot*)jcsn_index_slot(idx, key, hash);
+        if (slot->key)
+            continue;
+        *slot = (Jcsn_Index_Slot) {
+            .key = key,
+            .hash = hash,
+            .row = (uint32_t)r,
+        };
+        idx->len += 1;
+    }
+    return idx;
+}
+
+
+Jcsn_JValue *jcsn_index_lookup(const Jcsn_Index *idx, const Jcsn_JValue *key) {
+    const Jcsn_Index_Slot *slot;
+    uint32_t hash;
+
+    if (!idx || !key || jcsn_index_hash(key, &hash))
+        return NULL;
+
+    slot = jcsn_index_slot(idx, key, hash);
+    return (slot->key) ? jcsn_jarr_get(idx->arr, slot->row) : NULL;
+}
+
+
+Jcsn_JValue *jcsn_index_lookup_integer(const Jcsn_Index *idx, long key) {
+    Jcsn_JValue k = { .type = J_INTEGER };
+    k.data.integer = key;
+    return jcsn_index_lookup(idx, &k);
+}
+
+
+Jcsn_JValue *jcsn_index_lookup_string(const Jcsn_Index *idx, const char *key, size_t len) {
+    Jcsn_JValue k = { .type = J_STRING };
+    if (len > UINT32_MAX)
+        return NULL;
+    k.len = (uint32_t)len;
+    k.data.str = (char*)key;
+    return jcsn_index_lookup(idx, &k);
+}
+
+
+size_t jcsn_index_len(const Jcsn_Index *idx) {
+    return (idx) ? idx->len : 0;
+}
+
+
+void jcsn_index_free(Jcsn_Index *idx) {
+    xfree(idx);
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
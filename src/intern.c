@@ -0,0 +1,144 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Intern Module
+ * One canonical copy of each json object member name of a document
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#ifdef __JCSN_TRACE__
+    #include <stdio.h>
+#endif // __JCSN_TRACE__
+#include <stdlib.h>
+#include <string.h>
+
+// Jacson
+#include "log.h"
+#include "mem.h"
+#include "intern.h"
+
+
+
+/**
+ * Module Private API
+ */
+
+// Insert a slot into a table that has room for it
+static void jcsn_intern_insert(Jcsn_Intern_Slot *slots, size_t cap, const Jcsn_Intern_Slot *slot) {
+    size_t mask = cap - 1, i;
+    for (i = slot->hash & mask; slots[i].len || slots[i].str; i = (i + 1) & mask)
+        ;
+    slots[i] = *slot;
+}
+
+
+// Double number of slots
+static int jcsn_intern_grow(Jcsn_Intern *in) {
+    size_t cap = (in->cap) ? (in->cap << 1) : 64;
+    Jcsn_Intern_Slot *slots = calloc(cap, sizeof(*slots));
+    if (!slots)
+        return 1;
+
+    for (size_t i = 0; i < in->cap; i++)
+        if (in->slots[i].len || in->slots[i].str)
+            jcsn_intern_insert(slots, cap, &in->slots[i]);
+
+    xfree(in->slots);
+    in->slots = slots;
+    in->cap = cap;
+    return 0;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+void jcsn_intern_init(Jcsn_Intern *in) {
+    *in = (Jcsn_Intern) {
+        .slots = NULL,
+        .len = 0,
+        .cap = 0,
+    };
+}
+
+
+const Jcsn_Intern_Slot *jcsn_intern_find(const Jcsn_Intern *in,
+                                         const Jcsn_Pool *pool,
+                                         const char *s,
+                                         size_t len,
+                                         uint32_t hash)
+{
+    if (!in->cap)
+        return NULL;
+
+    size_t mask = in->cap - 1, i;
+    const Jcsn_Intern_Slot *slot;
+    // an empty slot has no length and no string
+    for (i = hash & mask; in->slots[i].len || in->slots[i].str; i = (i + 1) & mask) {
+        slot = &in->slots[i];
+        if (slot->hash == hash && slot->len == len
+            && memcmp(jcsn_intern_string(slot, pool), s, len) == 0)
+            return slot;
+    }
+    return NULL;
+}
+
+
+int jcsn_intern_add(Jcsn_Intern *in, uint32_t hash, size_t len, char *str, int64_t off) {
+    // keep load factor under 3/4
+    if ((in->len + 1) * 4 > in->cap * 3 && jcsn_intern_grow(in))
+        return 1;
+
+    Jcsn_Intern_Slot slot = {
+        .hash = hash,
+        .len = (uint32_t)len,
+        .str = str,
+        .off = off,
+    };
+    jcsn_intern_insert(in->slots, in->cap, &slot);
+    in->len += 1;
+    return 0;
+}
+
+
+char *jcsn_intern_string(const Jcsn_Intern_Slot *slot, const Jcsn_Pool *pool) {
+    return (slot->str) ? slot->str : (char*)pool->nodes + slot->off;
+}
+
+
+void jcsn_intern_free(Jcsn_Intern *in) {
+    if (in) {
+        xfree(in->slots);
+        in->len = 0;
+        in->cap = 0;
+    }
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
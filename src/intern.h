@@ -0,0 +1,88 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Intern Module
+ * One canonical copy of each json object member name of a document
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_INTERN_H
+#define __JACSON_INTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jvalue.h"
+
+
+/**
+ * Types
+ */
+
+// A canonical member name. It's either in raw json data (`str`) or it's
+// an unescaped copy in the node pool (`off`, absolute offset in bytes).
+typedef struct Jcsn_Intern_Slot {
+    uint32_t hash;
+    uint32_t len;
+    char *str;
+    int64_t off;
+} Jcsn_Intern_Slot;
+
+
+// Hash set of member names (open addressing, linear probing).
+// Equal member names in a document share the first one of them, so
+// names can be compared by address.
+typedef struct Jcsn_Intern {
+    Jcsn_Intern_Slot *slots;
+    size_t len;
+    size_t cap;
+} Jcsn_Intern;
+
+
+
+/**
+ * Module Public API
+ */
+
+// Initialize an empty table
+void jcsn_intern_init(Jcsn_Intern *in);
+
+// Find a name (`hash` is `jcsn_string_hash` of it). Names in `pool` are
+// read from `pool`. Returns NULL if there is no such name.
+const Jcsn_Intern_Slot *jcsn_intern_find(const Jcsn_Intern *in,
+                                         const Jcsn_Pool *pool,
+                                         const char *s,
+                                         size_t len,
+                                         uint32_t hash);
+
+// Add a name that is not in table yet. Either `str` is not NULL or
+// `off` is offset of name in the pool.
+// 0 -> ok
+// 1 -> out of memory
+int jcsn_intern_add(Jcsn_Intern *in, uint32_t hash, size_t len, char *str, int64_t off);
+
+// Get address of an interned name
+char *jcsn_intern_string(const Jcsn_Intern_Slot *slot, const Jcsn_Pool *pool);
+
+// Free memory of table
+void jcsn_intern_free(Jcsn_Intern *in);
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_INTERN_H
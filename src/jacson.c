@@ -33,9 +33,11 @@ extern "C" {
 
 // Jacson
 #include "mem.h"
-#include "jvalue.h"
+#include "atomic.h"
 #include "parser.h"
 #include "query.h"
+#include "validator.h"
+#include "tape.h"
 #include <jacson/jacson.h>
 
 
@@ -44,40 +46,207 @@ extern "C" {
  * Types
  */
 
+// A value returned by an on-demand query (`ast`) or by an aggregate
+// function of a query (`result`, if `ast` is NULL). Queries from many
+// threads push them to one list without a lock.
+typedef struct Jcsn_Value {
+    Jcsn_AST *ast;
+    Jcsn_JValue result;
+    struct Jcsn_Value *next;
+} Jcsn_Value;
+
+
 struct Jacson {
+    // Exactly one of them is used (See `JCSN_PARSE_TAPE`). In on-demand
+    // mode AST is only built if root of it is asked for.
     Jcsn_AST *ast;
+    Jcsn_Tape *tape;
+
+    // Raw json data and parsing options (See `JCSN_PARSE_ON_DEMAND`)
+    char *jdata;
+    int flags;
+
+    // Values returned by on-demand queries
+    Jcsn_Value *values;
 };
 
 
-Jacson *jcsn_parse_json(char *jdata) {
+
+/**
+ * Module Private API
+ */
+
+// Keep value of an on-demand query or result of an aggregate function
+// until `jcsn_free` (NULL if out of memory)
+static Jcsn_Value *jcsn_keep_value(Jacson *j, Jcsn_AST *value, const Jcsn_JValue *result) {
+    Jcsn_Value *v = malloc(sizeof(*v));
+    if (!v)
+        return NULL;
+
+    v->ast = value;
+    if (result)
+        v->result = *result;
+    v->next = jcsn_atomic_load_ptr((void**)&j->values);
+    while (!jcsn_atomic_cas_ptr((void**)&j->values, (void**)&v->next, v))
+        ;
+    return v;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+
+Jacson *jcsn_parse_json_flags(char *jdata, int flags) {
     Jacson *j = malloc(sizeof(*j));
     if (!j)
         return NULL;
     
     *j = (Jacson) {
-        .ast = jcsn_parser_parse_raw(jdata),
+        .ast = NULL,
+        .tape = NULL,
+        .jdata = jdata,
+        .flags = flags,
+        .values = NULL,
     };
 
-    if (!j->ast)
+    // nothing is parsed until it's queried
+    if (flags & JCSN_PARSE_ON_DEMAND)
+        return j;
+
+    if (flags & JCSN_PARSE_TAPE)
+        j->tape = jcsn_tape_parse_raw(jdata, flags);
+    else
+        j->ast = jcsn_parser_parse_raw(jdata, flags);
+
+    if (!j->ast && !j->tape)
         xfree(j);
 
     return j;
 }
 
 
+Jacson *jcsn_parse_json(char *jdata) {
+    return jcsn_parse_json_flags(jdata, JCSN_PARSE_DEFAULT);
+}
+
+
+Jacson *jcsn_parse_json_insitu(char *jdata) {
+    return jcsn_parse_json_flags(jdata, JCSN_PARSE_INSITU);
+}
+
+
+int jcsn_validate_json(const char *jdata, size_t len) {
+    return jcsn_validate_raw(jdata, len);
+}
+
+
 void jcsn_free(Jacson *j) {
+    Jcsn_Value *v = j->values, *next;
+    while (v) {
+        next = v->next;
+        jcsn_ast_free(v->ast);
+        free(v);
+        v = next;
+    }
     jcsn_ast_free(j->ast);
+    jcsn_tape_free(j->tape);
     xfree(j);
 }
 
 
 Jcsn_JValue *jcsn_ast_root(Jacson *j) {
-    return (j->ast) ? j->ast->root : NULL;
+    Jcsn_AST *ast = jcsn_atomic_load_ptr((void**)&j->ast);
+    void *other = NULL;
+
+    // threads that get here at the same time parse json data each and
+    // all of them use the first AST
+    if (!ast && (j->flags & JCSN_PARSE_ON_DEMAND)) {
+        ast = jcsn_parser_parse_raw(j->jdata, j->flags & ~(JCSN_PARSE_ON_DEMAND | JCSN_PARSE_INSITU));
+        if (ast && !jcsn_atomic_cas_ptr((void**)&j->ast, &other, ast)) {
+            jcsn_ast_free(ast);
+            ast = other;
+        }
+    }
+    return (ast) ? jcsn_ast_get_root(ast) : NULL;
 }
 
 
 Jcsn_JValue *jcsn_query_get(Jacson *j, const char *query) {
-    return jcsn_query_value(j->ast->root, query);
+    Jcsn_Query *q = jcsn_query_compile(query);
+    Jcsn_JValue *val = NULL, result;
+    Jcsn_AST *value = NULL;
+    Jcsn_Value *kept;
+
+    if (!q)
+        return NULL;
+
+    if (j->flags & JCSN_PARSE_ON_DEMAND) {
+        value = jcsn_query_raw(j->jdata, j->flags, q);
+        val = (value) ? jcsn_ast_get_root(value) : NULL;
+    } else if (j->ast) {
+        val = jcsn_query_target(q, jcsn_ast_get_root(j->ast));
+    }
+
+    // only result of function is kept, not the json array it reduced
+    if (val && jcsn_query_function(q) != AGG_NONE) {
+        kept = NULL;
+        if (!jcsn_agg_apply(jcsn_query_function(q), val, &result))
+            kept = jcsn_keep_value(j, NULL, &result);
+        val = (kept) ? &kept->result : NULL;
+        jcsn_ast_free(value);
+        value = NULL;
+    }
+
+    if (value && !jcsn_keep_value(j, value, NULL)) {
+        jcsn_ast_free(value);
+        val = NULL;
+    }
+    jcsn_query_free(q);
+    return val;
+}
+
+
+size_t jcsn_query_get_set(Jacson *j, const Jcsn_QuerySet *qs, Jcsn_JValue **results) {
+    if (!(j->flags & JCSN_PARSE_ON_DEMAND))
+        return jcsn_query_set_exec(qs, (j->ast) ? jcsn_ast_get_root(j->ast) : NULL, results);
+
+    size_t n = jcsn_query_set_len(qs), found;
+    bool kept = true;
+    Jcsn_AST **asts = malloc(sizeof(*asts) * ((n) ? n : 1));
+    if (!asts)
+        return jcsn_query_set_exec(qs, NULL, results);
+
+    found = jcsn_query_set_raw(j->jdata, j->flags, qs, results, asts);
+    for (size_t i = 0; i < n; i++) {
+        if (!asts[i])
+            continue;
+        if (!kept || !jcsn_keep_value(j, asts[i], NULL)) {
+            jcsn_ast_free(asts[i]);
+            kept = false;
+        }
+    }
+    xfree(asts);
+
+    // some values are already freed
+    if (!kept)
+        found = jcsn_query_set_exec(qs, NULL, results);
+    return found;
+}
+
+
+Jcsn_JString jcsn_intern(Jacson *j, const char *name, size_t len) {
+    Jcsn_AST *ast = jcsn_atomic_load_ptr((void**)&j->ast);
+    if (!ast)
+        return (Jcsn_JString) { .data = NULL, .len = 0 };
+    return jcsn_ast_intern(ast, name, len);
+}
+
+
+const Jcsn_Tape *jcsn_tape(Jacson *j) {
+    return j->tape;
 }
 
 
@@ -29,128 +29,429 @@ extern "C" {
     #include <stdio.h>
 #endif // __JCSN_TRACE__
 #include <stdlib.h>
-#include <stdbool.h>
 #include <string.h>
 
 // Jacson
 #include "log.h"
 #include "mem.h"
+#include "str.h"
+#include "atomic.h"
 #include "jvalue.h"
+#include <jacson/jacson.h>
 
 
 
 /**
- * Module Public API
+ * Macros and constants
  */
 
-Jcsn_JValue *jcsn_jval_new(enum Jcsn_JVal_T type) {
-    Jcsn_JValue *val = malloc(sizeof(*val));
-    if (!val)
-        goto ret;
+// A node is 16 bytes: 8 bytes of type, flags and length and 8 bytes of
+// scalar value or offsets. Keep it that way.
+typedef char jcsn_jvalue_size_check[(sizeof(Jcsn_JValue) == 16) ? 1 : -1];
 
-    *val = (Jcsn_JValue){
-        .type = type,
-        //.parsed = false,
-        .parent = NULL,
-    };
+// State of a hash index (`flags` of it's header node). Only the reader
+// that moves it from empty to building fills the slots.
+#define JCSN_JINDEX_EMPTY    0
+#define JCSN_JINDEX_READY    1
+#define JCSN_JINDEX_BUILDING 2
 
-ret:
-    return val;
+// `idx` of a `Jcsn_JLookup` of a member that objects of it's shape lack
+#define JCSN_JLOOKUP_MISS ((unsigned long)-1)
+
+
+
+/**
+ * Module Private API
+ */
+
+// Make room for `n` more nodes
+static int jcsn_pool_reserve(Jcsn_Pool *pool, size_t n) {
+    if (n > JCSN_POOL_MAX - pool->len) {
+        JCSN_LOG_ERR("Too many json values\n", NULL);
+        return 1;
+    }
+
+    if (pool->cap - pool->len >= n)
+        return 0;
+
+    size_t cap = (pool->cap) ? pool->cap : 16;
+    while (cap - pool->len < n)
+        cap <<= 1;
+    void *tmp = realloc(pool->nodes, sizeof(*pool->nodes) * cap);
+    if (!tmp)
+        return 1;
+    pool->nodes = tmp;
+    pool->cap = cap;
+    return 0;
 }
 
 
-// Construct a new json object
-Jcsn_JValue *jcsn_jobj_new(void) {
-    Jcsn_JValue *jval = jcsn_jval_new(J_OBJECT);
-    if (!jval)
-        return jval;
+static inline Jcsn_JValue *jcsn_jval_at(const Jcsn_JValue *val, int32_t off, size_t idx) {
+    return (Jcsn_JValue*)val + off + idx;
+}
 
-    Jcsn_JObject *obj = &jval->data.object;
 
-    *obj = (Jcsn_JObject){
-        .len = 0,
-        .cap = 4,
-    };
+// Number of slots in hash index of a json object with `n` members.
+// Load factor is kept under 3/4.
+static size_t jcsn_jindex_cap(size_t n) {
+    size_t cap = 16;
+    while (cap * 3 < n * 4)
+        cap <<= 1;
+    return cap;
+}
 
-    obj->names = malloc(sizeof(*obj->names) * obj->cap);
-    obj->values = malloc(sizeof(*obj->values) * obj->cap);
-    if (!obj->names || !obj->values) {
-        xfree(obj->names);
-        xfree(obj->values);
-        xfree(jval);
-    }
 
-    return jval;
+// Number of nodes that hold `cap` slots
+static inline size_t jcsn_jindex_nodes(size_t cap) {
+    return (cap * sizeof(Jcsn_JIndex_Slot) + sizeof(Jcsn_JValue) - 1) / sizeof(Jcsn_JValue);
 }
 
 
-int jcsn_jobj_add_name(Jcsn_JObject *jobj, const char *name) {
-    if (jobj->len == jobj->cap) {
-        jobj->cap <<= 1;
-        void *tmp = realloc(jobj->names, sizeof(*jobj->names) * jobj->cap);
-        if (!tmp)
-            return 0;
-        jobj->names = tmp;
-        tmp = realloc(jobj->values, sizeof(*jobj->values) * jobj->cap);
-        if (!tmp)
-            return 0;
-        jobj->values = tmp;
+// Hash index of a json object is a header node right before it's names
+// and slots before that. Header's `len` is number of slots and it's
+// `flags` is state of the index.
+static void jcsn_jindex_build(Jcsn_JValue *header, const Jcsn_JValue *names, size_t n) {
+    uint32_t mask = header->len - 1, h, i;
+    Jcsn_JIndex_Slot *slots = (Jcsn_JIndex_Slot*)(header - jcsn_jindex_nodes(header->len));
+    Jcsn_JString name, other;
+
+    memset(slots, 0, sizeof(*slots) * header->len);
+    for (size_t k = 0; k < n; k++) {
+        name = jcsn_jval_string(&names[k]);
+        h = jcsn_string_hash(name.data, name.len);
+        for (i = h & mask; slots[i].idx; i = (i + 1) & mask) {
+            if (slots[i].hash != h || slots[i].len != name.len)
+                continue;
+            // keep first of duplicate names
+            other = jcsn_jval_string(&names[slots[i].idx - 1]);
+            if (memcmp(other.data, name.data, name.len) == 0)
+                break;
+        }
+        if (!slots[i].idx)
+            slots[i] = (Jcsn_JIndex_Slot) {
+                .hash = h,
+                .len = (uint32_t)name.len,
+                .idx = (uint32_t)k + 1,
+            };
     }
-    jobj->names[jobj->len] = (char*)name;
-    jobj->len += 1;
-    return 1;
+    // slots are visible to readers that see the index ready
+    jcsn_atomic_store_u8(&header->flags, JCSN_JINDEX_READY);
 }
 
 
-Jcsn_JValue *jcsn_jobj_set_value(Jcsn_JObject *jobj, Jcsn_JValue *value) {
-    Jcsn_JValue *last = &jobj->values[jobj->len - 1];
-    memmove(last, value, sizeof(*value));
-    return last;
+// Linear search of member names of a json object
+static Jcsn_JValue *jcsn_jobj_scan(const Jcsn_JValue *obj, const char *name, size_t len) {
+    Jcsn_JString s;
+    const Jcsn_JValue *names = jcsn_jval_at(obj, obj->data.kids.names, 0);
+    for (size_t i = 0; i < obj->len; i++) {
+        if (names[i].len != len)
+            continue;
+        s = jcsn_jval_string(&names[i]);
+        if (memcmp(s.data, name, len) == 0)
+            return jcsn_jval_at(obj, obj->data.kids.vals, i);
+    }
+    return NULL;
 }
 
 
-Jcsn_JValue *jcsn_jarr_new(void) {
-    Jcsn_JValue *jval = jcsn_jval_new(J_ARRAY);
-    if (!jval)
-        goto ret;
-    Jcsn_JArray *arr = &jval->data.array;
+static Jcsn_JValue *jcsn_jindex_get(const Jcsn_JValue *obj,
+                                    const char *name,
+                                    size_t len,
+                                    uint32_t h)
+{
+    Jcsn_JValue *names = jcsn_jval_at(obj, obj->data.kids.names, 0);
+    Jcsn_JValue *header = names - 1;
+    unsigned char state = jcsn_atomic_load_u8(&header->flags);
+
+    // Index is built by the first lookup. Lookups from other threads
+    // scan names linearly until it's ready.
+    if (state != JCSN_JINDEX_READY) {
+        if (state != JCSN_JINDEX_EMPTY
+            || !jcsn_atomic_cas_u8(&header->flags, &state, JCSN_JINDEX_BUILDING))
+            return jcsn_jobj_scan(obj, name, len);
+        jcsn_jindex_build(header, names, obj->len);
+    }
+
+    uint32_t mask = header->len - 1, i;
+    const Jcsn_JIndex_Slot *slots =
+        (Jcsn_JIndex_Slot*)(header - jcsn_jindex_nodes(header->len));
+    Jcsn_JString s;
+
+    for (i = h & mask; slots[i].idx; i = (i + 1) & mask) {
+        if (slots[i].hash != h || slots[i].len != len)
+            continue;
+        // interned names are equal by address
+        s = jcsn_jval_string(&names[slots[i].idx - 1]);
+        if (s.data == name || memcmp(s.data, name, len) == 0)
+            return jcsn_jval_at(obj, obj->data.kids.vals, slots[i].idx - 1);
+    }
+    return NULL;
+}
+
+
+
+/**
+ * Module Public API
+ */
 
-    *arr = (Jcsn_JArray){
+int jcsn_pool_init(Jcsn_Pool *pool, size_t cap) {
+    *pool = (Jcsn_Pool) {
+        .nodes = NULL,
         .len = 0,
-        .cap = 4,
+        .cap = 0,
     };
-    arr->vals = malloc(sizeof(*arr->vals) * arr->cap);
+    return jcsn_pool_reserve(pool, cap);
+}
+
 
-ret:
-    return jval;
+int jcsn_pool_push(Jcsn_Pool *pool, const Jcsn_JValue *node) {
+    if (pool->len == pool->cap && jcsn_pool_reserve(pool, 1))
+        return 1;
+    pool->nodes[pool->len++] = *node;
+    return 0;
 }
 
 
-Jcsn_JValue *jcsn_jarr_append(Jcsn_JArray *jarr, Jcsn_JValue *value) {
-    if (jarr->len == jarr->cap) {
-        jarr->cap <<= 1;
-        void *tmp = realloc(jarr->vals, jarr->cap * sizeof(*jarr->vals));
-        if (!tmp) {
-            JCSN_LOG_ERR("%s: Failed to grow json array's memory\n", __FUNCTION__);
-            return NULL;
+int jcsn_pool_place(Jcsn_Pool *pool, const Jcsn_JValue *src, size_t n, size_t stride) {
+    if (jcsn_pool_reserve(pool, n))
+        return 1;
+
+    Jcsn_JValue *dst = &pool->nodes[pool->len];
+    int32_t at = (int32_t)pool->len;
+    for (size_t i = 0; i < n; i++, at++, src += stride) {
+        dst[i] = *src;
+        if (src->type == J_OBJECT || src->type == J_ARRAY) {
+            dst[i].data.kids.names -= at;
+            dst[i].data.kids.vals -= at;
+        } else if (src->flags & JCSN_JVAL_POOLED) {
+            dst[i].data.off -= (int64_t)at * (int64_t)sizeof(Jcsn_JValue);
         }
-        jarr->vals = tmp;
     }
-    Jcsn_JValue *last = &jarr->vals[jarr->len];
-    memmove(last, value, sizeof(*value));
-    jarr->len += 1;
-    return last;
+    pool->len += n;
+    return 0;
+}
+
+
+int jcsn_pool_index(Jcsn_Pool *pool, size_t n) {
+    size_t cap = jcsn_jindex_cap(n), nodes = jcsn_jindex_nodes(cap);
+    if (jcsn_pool_reserve(pool, nodes + 1))
+        return 1;
+
+    pool->len += nodes;
+    pool->nodes[pool->len++] = (Jcsn_JValue) {
+        .type = J_NULL,
+        .flags = JCSN_JINDEX_EMPTY,
+        .len = (uint32_t)cap,
+    };
+    return 0;
+}
+
+
+int64_t jcsn_pool_pack(Jcsn_Pool *pool, const Jcsn_JValue *src, size_t n, enum Jcsn_JVal_T type) {
+    size_t size = (type == J_INTEGER) ? sizeof(long) : sizeof(double);
+    size_t nodes = (n * size + sizeof(Jcsn_JValue) - 1) / sizeof(Jcsn_JValue);
+    if (jcsn_pool_reserve(pool, nodes))
+        return -1;
+
+    int64_t at = (int64_t)pool->len;
+    if (type == J_INTEGER) {
+        long *longs = (long*)&pool->nodes[pool->len];
+        for (size_t i = 0; i < n; i++)
+            longs[i] = src[i].data.integer;
+    } else {
+        double *doubles = (double*)&pool->nodes[pool->len];
+        for (size_t i = 0; i < n; i++)
+            doubles[i] = src[i].data.real;
+    }
+    pool->len += nodes;
+    return at;
+}
+
+
+void jcsn_pool_shrink(Jcsn_Pool *pool) {
+    if (pool->len == pool->cap || pool->len == 0)
+        return;
+
+    // nothing is lost if this fails
+    void *tmp = realloc(pool->nodes, sizeof(*pool->nodes) * pool->len);
+    if (tmp) {
+        pool->nodes = tmp;
+        pool->cap = pool->len;
+    }
 }
 
 
-// Construct a new json string
-Jcsn_JValue *jcsn_jstr_new(const char *str) {
-    Jcsn_JValue *val = jcsn_jval_new(J_STRING);
-    val->data.string = (char*)str;
+int64_t jcsn_pool_strndup(Jcsn_Pool *pool, const char *s, size_t len) {
+    // string takes whole nodes, that are never reached as json values
+    size_t n = (len + sizeof(Jcsn_JValue)) / sizeof(Jcsn_JValue);
+    if (jcsn_pool_reserve(pool, n))
+        return -1;
+
+    char *str = (char*)&pool->nodes[pool->len];
+    memcpy(str, s, len);
+    str[len] = '\0';
+
+    int64_t off = (int64_t)(pool->len * sizeof(Jcsn_JValue));
+    pool->len += n;
+    return off;
+}
+
+
+void jcsn_pool_free(Jcsn_Pool *pool) {
+    if (pool) {
+        xfree(pool->nodes);
+        pool->len = 0;
+        pool->cap = 0;
+    }
+}
+
+
+size_t jcsn_jarr_len(const Jcsn_JValue *arr) {
+    return (arr->type == J_ARRAY) ? arr->len : 0;
+}
+
+
+Jcsn_JValue *jcsn_jarr_get(const Jcsn_JValue *arr, size_t idx) {
+    if (arr->type != J_ARRAY || idx >= arr->len || (arr->flags & JCSN_JVAL_PACKED))
+        return NULL;
+    return jcsn_jval_at(arr, arr->data.kids.vals, idx);
+}
+
+
+enum Jcsn_JVal_T jcsn_jarr_type(const Jcsn_JValue *arr, size_t idx) {
+    if (arr->type != J_ARRAY || idx >= arr->len)
+        return J_NULL;
+    if (arr->flags & JCSN_JVAL_LONGS)
+        return J_INTEGER;
+    if (arr->flags & JCSN_JVAL_DOUBLES)
+        return J_REAL;
+    return (enum Jcsn_JVal_T)jcsn_jval_at(arr, arr->data.kids.vals, idx)->type;
+}
+
+
+long jcsn_jarr_integer(const Jcsn_JValue *arr, size_t idx) {
+    if (jcsn_jarr_type(arr, idx) != J_INTEGER)
+        return 0;
+    if (arr->flags & JCSN_JVAL_LONGS)
+        return jcsn_jarr_as_longs(arr)[idx];
+    return jcsn_jval_at(arr, arr->data.kids.vals, idx)->data.integer;
+}
+
+
+double jcsn_jarr_real(const Jcsn_JValue *arr, size_t idx) {
+    if (jcsn_jarr_type(arr, idx) != J_REAL)
+        return 0;
+    if (arr->flags & JCSN_JVAL_DOUBLES)
+        return jcsn_jarr_as_doubles(arr)[idx];
+    return jcsn_jval_at(arr, arr->data.kids.vals, idx)->data.real;
+}
+
+
+const long *jcsn_jarr_as_longs(const Jcsn_JValue *arr) {
+    if (arr->type != J_ARRAY || !(arr->flags & JCSN_JVAL_LONGS))
+        return NULL;
+    return (const long*)jcsn_jval_at(arr, arr->data.kids.vals, 0);
+}
+
+
+const double *jcsn_jarr_as_doubles(const Jcsn_JValue *arr) {
+    if (arr->type != J_ARRAY || !(arr->flags & JCSN_JVAL_DOUBLES))
+        return NULL;
+    return (const double*)jcsn_jval_at(arr, arr->data.kids.vals, 0);
+}
+
+
+size_t jcsn_jobj_len(const Jcsn_JValue *obj) {
+    return (obj->type == J_OBJECT) ? obj->len : 0;
+}
+
+
+Jcsn_JString jcsn_jobj_name(const Jcsn_JValue *obj, size_t idx) {
+    if (obj->type != J_OBJECT || idx >= obj->len)
+        return (Jcsn_JString) { .data = NULL, .len = 0 };
+    return jcsn_jval_string(jcsn_jval_at(obj, obj->data.kids.names, idx));
+}
+
+
+Jcsn_JValue *jcsn_jobj_value(const Jcsn_JValue *obj, size_t idx) {
+    if (obj->type != J_OBJECT || idx >= obj->len)
+        return NULL;
+    return jcsn_jval_at(obj, obj->data.kids.vals, idx);
+}
+
+
+Jcsn_JValue *jcsn_jobj_get(const Jcsn_JValue *obj, const char *name, size_t len) {
+    if (obj->type != J_OBJECT)
+        return NULL;
+    if (obj->flags & JCSN_JVAL_INDEXED)
+        return jcsn_jindex_get(obj, name, len, jcsn_string_hash(name, len));
+    return jcsn_jobj_scan(obj, name, len);
+}
+
+
+Jcsn_JValue *jcsn_jobj_find(const Jcsn_JValue *obj, const char *name, size_t len, uint32_t hash) {
+    if (obj->type != J_OBJECT)
+        return NULL;
+    if (obj->flags & JCSN_JVAL_INDEXED)
+        return jcsn_jindex_get(obj, name, len, hash);
+    return jcsn_jobj_scan(obj, name, len);
+}
+
+
+Jcsn_JValue *jcsn_jobj_get_cached(const Jcsn_JValue *obj,
+                                  const char *name,
+                                  size_t len,
+                                  Jcsn_JLookup *cache)
+{
+    // names of an empty json object may be at the address of names of
+    // the next one
+    if (obj->type != J_OBJECT || obj->len == 0)
+        return NULL;
+
+    // same names at same address means same shape
+    const Jcsn_JValue *names = jcsn_jval_at(obj, obj->data.kids.names, 0);
+    if (cache->names == names && cache->name == name && cache->len == len) {
+        if (cache->idx == JCSN_JLOOKUP_MISS)
+            return NULL;
+        if (cache->idx < obj->len)
+            return jcsn_jval_at(obj, obj->data.kids.vals, cache->idx);
+    }
+
+    Jcsn_JValue *val = jcsn_jobj_get(obj, name, len);
+    *cache = (Jcsn_JLookup) {
+        .names = names,
+        .idx = (val) ? (unsigned long)(val - jcsn_jval_at(obj, obj->data.kids.vals, 0)) : JCSN_JLOOKUP_MISS,
+        .name = name,
+        .len = (unsigned long)len,
+    };
     return val;
 }
 
 
+Jcsn_JValue *jcsn_jobj_get_interned(const Jcsn_JValue *obj, Jcsn_JString name) {
+    if (obj->type != J_OBJECT || !name.data)
+        return NULL;
+    if (obj->flags & JCSN_JVAL_INDEXED)
+        return jcsn_jindex_get(obj, name.data, name.len, jcsn_string_hash(name.data, name.len));
+
+    const Jcsn_JValue *names = jcsn_jval_at(obj, obj->data.kids.names, 0);
+    for (size_t i = 0; i < obj->len; i++) {
+        if (names[i].len == name.len && jcsn_jval_string(&names[i]).data == name.data)
+            return jcsn_jval_at(obj, obj->data.kids.vals, i);
+    }
+    return NULL;
+}
+
+
+Jcsn_JString jcsn_jval_string(const Jcsn_JValue *str) {
+    if (str->type != J_STRING)
+        return (Jcsn_JString) { .data = NULL, .len = 0 };
+    if (str->flags & JCSN_JVAL_POOLED)
+        return (Jcsn_JString) { .data = (char*)str + str->data.off, .len = str->len };
+    return (Jcsn_JString) { .data = str->data.str, .len = str->len };
+}
+
+
 
 #ifdef __cplusplus
 }
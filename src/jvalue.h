@@ -27,29 +27,109 @@ extern "C" {
 
 
 /**
- * Module Public API
+ * Macros and constants
+ */
+
+// `Jcsn_JValue.flags`: json string is stored in the pool (`data.off`)
+// instead of raw json data (`data.str`)
+#define JCSN_JVAL_POOLED (1 << 0)
+
+// `Jcsn_JValue.flags`: json object has room for a hash index of it's
+// member names right before them (See `jcsn_pool_index`)
+#define JCSN_JVAL_INDEXED (1 << 1)
+
+// `Jcsn_JValue.flags`: elements of json array are packed in the pool as a
+// `long` array (`JCSN_JVAL_LONGS`) or a `double` array
+// (`JCSN_JVAL_DOUBLES`) instead of nodes
+#define JCSN_JVAL_LONGS   (1 << 2)
+#define JCSN_JVAL_DOUBLES (1 << 3)
+#define JCSN_JVAL_PACKED  (JCSN_JVAL_LONGS | JCSN_JVAL_DOUBLES)
+
+// Json objects with at least this many members are looked up through a
+// hash index. Smaller ones are scanned linearly (See test/bench.c).
+#ifndef JCSN_JOBJ_INDEX_MIN
+    #define JCSN_JOBJ_INDEX_MIN 16
+#endif
+
+// Offsets between nodes are 32 bits, so is the size of a pool
+#define JCSN_POOL_MAX ((size_t)INT32_MAX)
+
+
+
+/**
+ * Types
  */
 
-// Construct a new general json value
-Jcsn_JValue *jcsn_jval_new(enum Jcsn_JVal_T type);
+// A growable array of nodes. Parser builds an AST bottom-up: children
+// of a json object/array are moved into the pool, next to each other,
+// when it's closed. Until then, they live in a second pool used as a
+// stack. In that stack, offsets of a node are absolute (from start of
+// the pool) and become relative when node is moved into it's place.
+typedef struct Jcsn_Pool {
+    Jcsn_JValue *nodes;
+    size_t len;
+    size_t cap;
+} Jcsn_Pool;
+
 
-// Construct a new json object
-Jcsn_JValue *jcsn_jobj_new(void);
 
-// Add a name to json object
-int jcsn_jobj_add_name(Jcsn_JObject *jobj, const char *name);
+// A slot in hash index of a json object. Hash and length of a name are
+// compared before the name itself.
+typedef struct Jcsn_JIndex_Slot {
+    uint32_t hash;
+    uint32_t len;
 
-// Set a neme's value in json object
-Jcsn_JValue *jcsn_jobj_set_value(Jcsn_JObject *jobj, Jcsn_JValue *value);
+    // Index of member + 1 (0 -> empty slot)
+    uint32_t idx;
+} Jcsn_JIndex_Slot;
 
-// Construct a new json array
-Jcsn_JValue *jcsn_jarr_new(void);
 
-// Append a json value to json array
-Jcsn_JValue *jcsn_jarr_append(Jcsn_JArray *jarr, Jcsn_JValue *value);
 
-// Construct a new json string
-Jcsn_JValue *jcsn_jstr_new(const char *str);
+/**
+ * Module Public API
+ */
+
+// Initialize an empty pool with room for `cap` nodes
+// 0 -> ok
+// 1 -> out of memory
+int jcsn_pool_init(Jcsn_Pool *pool, size_t cap);
+
+// Append a node as is
+// 0 -> ok
+// 1 -> out of memory or pool is full
+int jcsn_pool_push(Jcsn_Pool *pool, const Jcsn_JValue *node);
+
+// Move `n` nodes into the pool, one every `stride` nodes of `src`, and
+// make their absolute offsets relative to their new place.
+// 0 -> ok
+// 1 -> out of memory or pool is full
+int jcsn_pool_place(Jcsn_Pool *pool, const Jcsn_JValue *src, size_t n, size_t stride);
+
+// Reserve room for hash index of a json object with `n` members. Names
+// of the object must be placed right after it. Index is built on first
+// lookup.
+// 0 -> ok
+// 1 -> out of memory or pool is full
+int jcsn_pool_index(Jcsn_Pool *pool, size_t n);
+
+// Copy values of `n` nodes of `src`, all of them J_INTEGER or J_REAL
+// (`type`), into the pool as a `long` or `double` array.
+// Returns absolute index of it's first node or -1 on error.
+int64_t jcsn_pool_pack(Jcsn_Pool *pool, const Jcsn_JValue *src, size_t n, enum Jcsn_JVal_T type);
+
+// Give unused capacity of pool back. Pool may move.
+void jcsn_pool_shrink(Jcsn_Pool *pool);
+
+// Copy `len` bytes of `s` into the pool (null terminated).
+// Returns absolute offset of the copy in bytes or -1 on error.
+int64_t jcsn_pool_strndup(Jcsn_Pool *pool, const char *s, size_t len);
+
+// Free memory of pool
+void jcsn_pool_free(Jcsn_Pool *pool);
+
+// `jcsn_jobj_get` with hash of `name` already computed (See
+// `jcsn_string_hash`)
+Jcsn_JValue *jcsn_jobj_find(const Jcsn_JValue *obj, const char *name, size_t len, uint32_t hash);
 
 
 
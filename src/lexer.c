@@ -28,13 +28,17 @@ extern "C" {
 
 // Standard library
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #ifdef __JCSN_TRACE__
     #include <stdio.h>
 #endif // __JCSN_TRACE__
 
 // Jacson
+#include <jacson/jacson.h>
 #include "lexer.h"
+#include "scan.h"
 #include "str.h"
 #include "mem.h"
 #include "log.h"
@@ -45,22 +49,6 @@ extern "C" {
  * Types
  */
 
-typedef struct Jcsn_Tokenizer {
-    // Since we're working with pointer arithmic, keep a pointer to
-    // first character in json data to prevent out of bound access
-    // to memory locations if parser wants to go backward.
-    char *first;
-
-    // Pointer to base character in raw json data
-    // (Used to extract tokens (sub-strings) with `curr` field)
-    char *base;
-
-
-    // Pointer to current character in raw json data
-    char *curr;
-} Jcsn_Tokenizer;
-
-
 typedef struct Jcsn_JNumber {
     union {
         long integer;
@@ -76,136 +64,369 @@ typedef struct Jcsn_JNumber {
  * Module Private API
  */
 
-static int jcsn_tlist_append(Jcsn_TList *tlist, Jcsn_Token *token) {
-    if (tlist->len == tlist->cap) {
-        tlist->cap <<= 1;
-        void *tmp = realloc(tlist->tokens, tlist->cap * sizeof(*tlist->tokens));
-        if (!tmp) {
-            JCSN_LOG_ERR("Failed to reallocate memory for token list\n", NULL);
+// Scanner only reports the first character of a number or literal.
+// Make sure the token we parsed covers all of it.
+static int jcsn_scalar_ended(Jcsn_Lexer *lexer) {
+    char ch;
+    if (lexer->base >= lexer->last)
+        return 1;
+    ch = *lexer->base;
+    return jcsn_char_is_whitespace(ch) || jcsn_char_is_structural(ch) || ch == '\"';
+}
+
+
+// Append to an unescaped json string. In in-situ mode unescaped string is
+// written back into raw json data at `*w`, otherwise into lexer's scratch
+// buffer.
+// Nothing is written in validate-only mode.
+static int jcsn_unescape_append(Jcsn_Lexer *lexer,
+                                char **w,
+                                const char *s,
+                                size_t slen)
+{
+    if (lexer->flags & JCSN_LEX_VALIDATE_ONLY)
+        return 0;
+    if (lexer->flags & JCSN_PARSE_INSITU) {
+        memmove(*w, s, slen);
+        *w += slen;
+        return 0;
+    }
+    return jcsn_string_append(&lexer->scratch, s, slen);
+}
+
+
+// parse 4 hex digits of a `\\uXXXX` escape
+static int jcsn_parse_hex4(const char *p, const char *last, unsigned long *cp) {
+    char ch;
+    int i;
+
+    if (last - p < 4)
+        return 1;
+
+    *cp = 0;
+    for (i = 0; i < 4; i++) {
+        ch = p[i];
+        *cp <<= 4;
+        if (jcsn_char_is_digit(ch))
+            *cp |= ch - '0';
+        else if (ch >= 'a' && ch <= 'f')
+            *cp |= ch - 'a' + 10;
+        else if (ch >= 'A' && ch <= 'F')
+            *cp |= ch - 'A' + 10;
+        else
             return 1;
-        }
-        tlist->tokens = tmp;
     }
-    tlist->tokens[tlist->len] = *token;
-    tlist->len += 1;
     return 0;
 }
 
 
-// extract a string in between two quotes
-static char *jcsn_extract_json_string(char **base, char **curr) {
-    char ch, *sub = NULL;
-    Jcsn_String str = jcsn_string_new();
+// Decode a `\\uXXXX` escape (or a surrogate pair of them) at `p` into
+// utf-8. `p` points to `u` character. `*end` is set to last character
+// of the escape. Returns number of bytes written to `out` or 0 on error.
+static int jcsn_decode_unicode(const char *p, const char *last,
+                               const char **end,
+                               char out[4])
+{
+    unsigned long cp, lo;
+
+    if (jcsn_parse_hex4(p + 1, last, &cp))
+        return 0;
+    p += 4;
+
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        // high surrogate must be followed by a low surrogate
+        if (last - p < 3 || p[1] != '\\' || p[2] != 'u')
+            return 0;
+        if (jcsn_parse_hex4(p + 3, last, &lo) || lo < 0xDC00 || lo > 0xDFFF)
+            return 0;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        p += 6;
+    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        // lonely low surrogate
+        return 0;
+    }
+    *end = p;
+
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+
+// extract a string in between two quotes.
+// If string has no escapes, `jstr` points into raw json data and nothing
+// is copied. Otherwise it's unescaped into lexer's scratch buffer, or in
+// in-situ mode, in place.
+// Escape-free runs are found with SIMD and copied as a whole.
+static int jcsn_extract_json_string(Jcsn_Lexer *lexer, Jcsn_JString *jstr)
+{
+    char ch[4], *start, *w;
+    const char *esc_end;
+    int n;
+    bool escaped = false, insitu = (lexer->flags & JCSN_PARSE_INSITU);
+    bool validate_only = (lexer->flags & JCSN_LEX_VALIDATE_ONLY);
+    char *copy;
+    char **base = &lexer->base, **curr = &lexer->curr;
 
     // skip first `"` character
     *curr = (*base += 1);
+    start = w = *base;
+
+    while (1) {
+        *curr = (char*)jcsn_scan_string(*curr, lexer->last);
+        if (*curr == lexer->last) {
+            JCSN_LOG_ERR("Json string is not terminated\n", NULL);
+            goto err;
+        }
 
-    while (**curr && **curr != '\"') {
-        if (**curr == '\\') {
-            sub = jcsn_string_substring(*base, *curr);
-            jcsn_string_append(&str, sub, strlen(sub));
-            xfree(sub);
-
-            *curr += 1;
-            switch (**curr) {
-                case '\"':
-                    ch = '\"';
-                    break;
-                case '\\':
-                    ch = '\\';
-                    break;
-                case '/':
-                    ch = '/';
-                    break;
-                case 'b':
-                    ch = '\b';
-                    break;
-                case 'n':
-                    ch = '\n';
-                    break;
-                case 'r':
-                    ch = '\r';
-                    break;
-                case 't':
-                    ch = '\t';
-                    break;
-                case 'f':
-                    ch = '\f';
-                    break;
+        // Non-ascii bytes can only appear inside json strings (anywhere else
+        // lexer rejects them), so checking each escape-free run while it is
+        // still in cache validates the whole json data.
+        if ((lexer->flags & JCSN_PARSE_VALIDATE_UTF8)
+            && !jcsn_utf8_valid(*base, *curr - *base))
+        {
+            JCSN_LOG_ERR("Invalid utf-8 sequence in json string\n", NULL);
+            goto err;
+        }
+        if (**curr == '\"')
+            break;
+        if (**curr != '\\') {
+            JCSN_LOG_ERR("Unescaped control character in json string\n", NULL);
+            goto err;
+        }
+
+        if (!escaped && !insitu && !validate_only) {
+            // scratch buffer is reused for every escaped string
+            if (!lexer->scratch.data)
+                lexer->scratch = jcsn_string_new();
+            lexer->scratch.len = 0;
+        }
+        escaped = true;
+        if (jcsn_unescape_append(lexer, &w, *base, *curr - *base))
+            goto err;
+
+        *curr += 1;
+        n = 1;
+        switch (*curr < lexer->last ? **curr : '\0') {
+            case '\"':
+                ch[0] = '\"';
+                break;
+            case '\\':
+                ch[0] = '\\';
+                break;
+            case '/':
+                ch[0] = '/';
+                break;
+            case 'b':
+                ch[0] = '\b';
+                break;
+            case 'n':
+                ch[0] = '\n';
+                break;
+            case 'r':
+                ch[0] = '\r';
+                break;
+            case 't':
+                ch[0] = '\t';
+                break;
+            case 'f':
+                ch[0] = '\f';
+                break;
+            case 'u': {
+                n = jcsn_decode_unicode(*curr, lexer->last, &esc_end, ch);
+                if (n == 0) {
+                    JCSN_LOG_ERR("Invalid unicode escape sequence in json string\n", NULL);
+                    goto err;
+                }
+                *curr = (char*)esc_end;
+            }
+            break;
+            default: {
+                JCSN_LOG_ERR("Invalid escape sequence in json string\n", NULL);
+                goto err;
             }
-            jcsn_string_append(&str, &ch, 1);
-            *base = *curr + 1;
         }
+        if (jcsn_unescape_append(lexer, &w, ch, n))
+            goto err;
         *curr += 1;
+        *base = *curr;
     }
 
-    if (**curr == '\0') {
-        xfree(sub);
-        xfree(str.data);
-        return NULL;
-    }
-
-    sub = jcsn_string_substring(*base, *curr);
-    jcsn_string_append(&str, sub, strlen(sub));
-
-#ifdef __JCSN_TRACE__
-    if (str.data == NULL) {
-        JCSN_LOG_ERR("jcsn_substr_ptr returned NULL\n", NULL);
-        JCSN_LOG_ERR("Failed to parse a json string\n", NULL);
-        JCSN_LOG_INF("Returning NULL\n", NULL);
+    if (!escaped || validate_only) {
+        *jstr = (Jcsn_JString) { .data = start, .len = *curr - start };
+        w = *curr;
+    } else {
+        if (jcsn_unescape_append(lexer, &w, *base, *curr - *base))
+            goto err;
+        if (insitu) {
+            *jstr = (Jcsn_JString) { .data = start, .len = w - start };
+        } else {
+            copy = lexer->scratch.data;
+            if (!copy)
+                goto err;
+            *jstr = (Jcsn_JString) { .data = copy, .len = lexer->scratch.len };
+        }
     }
-#endif // __JCSN_TRACE__
 
     // put *base after last `"` character
     *base = (*curr += 1);
-    xfree(sub);
-    return str.data;
+
+    // In-situ strings are null terminated. Unescaped string is never longer
+    // than the raw one, so there is always room for it (at worst, closing
+    // quote is overwritten). Scanner must not read modified bytes again.
+    jcsn_scanner_seek(&lexer->scanner, *base - lexer->first);
+    if (insitu)
+        *w = '\0';
+    return 0;
+
+err:
+    return 1;
 }
 
 
-// parse a number in json data to it's actual value
-static Jcsn_JNumber jcsn_parse_json_number(char **base, char **curr) {
-    char ch, *tmp = NULL;
-    // first bit: negative flag
-    // second bit: floating point flag
-    char flags = 0;
+// read a character without going past end of json data
+static inline char jcsn_peek(const char *p, const char *last) {
+    return (p < last) ? *p : '\0';
+}
+
+
+// match a json literal (`true`, `false` or `null`) at `p`
+static char *jcsn_match_literal(char *p, const char *last, const char *lit, size_t len) {
+    if ((size_t)(last - p) < len || memcmp(p, lit, len) != 0)
+        return NULL;
+    return p + len;
+}
+
+
+// Powers of ten that are exactly representable by a double
+static const double jcsn_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+
+// parse a number in json data to it's actual value.
+// Number is validated and converted in a single pass without any
+// allocation. Digits are accumulated into an integer mantissa and a
+// decimal exponent. If both are small enough to be exact in a double,
+// result is a single (correctly rounded) multiplication or division.
+// Otherwise `strtod` does the conversion from raw json data.
+static Jcsn_JNumber jcsn_parse_json_number(char **base, char **curr,
+                                           const char *last, bool convert)
+{
+    char *p = *base;
+    bool neg = false, real = false, truncated = false, eneg = false;
+    uint64_t mant = 0;
+    int digits = 0;
+    long exp10 = 0, e = 0;
+    double d;
     Jcsn_JNumber num = {
         .value = { 0 },
         .type = TK_NULL,
     };
 
-    switch (**base) {
-        case '-':
-            flags |= 0x1u;
-        case '+':
-            *base += 1;
+    if (jcsn_peek(p, last) == '-') {
+        neg = true;
+        p += 1;
     }
 
-    *curr = (*base + 1);
-    while ((ch = **curr)) {
-        if (jcsn_char_is_digit(ch)) {
-            *curr += 1;
+    // integer part (no leading zeros allowed)
+    if (jcsn_peek(p, last) == '0') {
+        p += 1;
+    } else if (jcsn_char_is_digit(jcsn_peek(p, last))) {
+        for (; jcsn_char_is_digit(jcsn_peek(p, last)); p++) {
+            if (digits < 19) {
+                mant = (mant * 10) + (*p - '0');
+                digits += 1;
+            } else {
+                exp10 += 1;
+                truncated = true;
+            }
         }
-        else if (ch == '.' && jcsn_char_is_digit(*(*curr += 1))) {
-            if (flags & 0x2u) // invalid number
-                return num;
-            flags |= 0x2u;
+    } else {
+        return num;
+    }
+
+    // fraction part
+    if (jcsn_peek(p, last) == '.') {
+        real = true;
+        p += 1;
+        if (!jcsn_char_is_digit(jcsn_peek(p, last)))
+            return num;
+        for (; jcsn_char_is_digit(jcsn_peek(p, last)); p++) {
+            if (digits < 19) {
+                mant = (mant * 10) + (*p - '0');
+                // leading zeros of fraction are not significant
+                digits += (mant != 0);
+                exp10 -= 1;
+            } else {
+                truncated = true;
+            }
         }
-        else
-            break;
     }
 
-    tmp = jcsn_string_substring(*base, *curr);
-    if (flags & 0x2u) {
-        num.value.real = (flags & 0x1u) ? (-(atof(tmp))) : atof(tmp);
-        num.type = TK_REAL;
+    // exponent part
+    if ((jcsn_peek(p, last) | 0x20) == 'e') {
+        real = true;
+        p += 1;
+        if (jcsn_peek(p, last) == '-' || jcsn_peek(p, last) == '+') {
+            eneg = (*p == '-');
+            p += 1;
+        }
+        if (!jcsn_char_is_digit(jcsn_peek(p, last)))
+            return num;
+        for (; jcsn_char_is_digit(jcsn_peek(p, last)); p++)
+            if (e < 100000)
+                e = (e * 10) + (*p - '0');
+        exp10 += (eneg) ? -e : e;
+    }
+
+    if (!real && !truncated) {
+        if (mant <= (uint64_t)LONG_MAX) {
+            num.value.integer = (neg) ? -((long)mant) : (long)mant;
+            num.type = TK_INTEGER;
+            goto ret;
+        }
+        if (neg && mant == (uint64_t)LONG_MAX + 1) {
+            num.value.integer = LONG_MIN;
+            num.type = TK_INTEGER;
+            goto ret;
+        }
+        // does not fit in a long, fallback to a real number
+    }
+
+    if (!convert) {
+        // only validating, value is not needed
+    } else if (!truncated && mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        d = (double)mant;
+        d = (exp10 < 0) ? (d / jcsn_pow10[-exp10]) : (d * jcsn_pow10[exp10]);
+        num.value.real = (neg) ? -d : d;
     } else {
-        num.value.integer = (flags & 0x1u) ? (-(atol(tmp))) : atol(tmp);
-        num.type = TK_INTEGER;
+        // Slow path, `strtod` stops at the same character as we did
+        num.value.real = strtod(*base, NULL);
     }
+    num.type = TK_REAL;
 
-    *base = *curr;
-    xfree(tmp);
+ret:
+    *base = *curr = p;
     return num;
 }
 
@@ -215,168 +436,211 @@ static Jcsn_JNumber jcsn_parse_json_number(char **base, char **curr) {
  * Module Public API
  */
 
-// Free all memory allocated by a token list
-void jcsn_tlist_free(Jcsn_TList *tl) {
-    Jcsn_Token t;
-    if (tl) {
-        for (size_t i = 0; i < tl->len; i++) {
-            t = tl->tokens[i];
-            if (t.type == TK_STRING)
-                xfree(t.value.string);
-        }
-        xfree(tl->tokens);
-        tl->len = 0;
-        tl->cap = 0;
-    }
-}
-
-
-Jcsn_TList jcsn_tokenize_json(char *jdata) {
-    Jcsn_Tokenizer tokenizer = {
+void jcsn_lexer_init(Jcsn_Lexer *lexer, char *jdata, size_t len, int flags) {
+    *lexer = (Jcsn_Lexer) {
         .first = jdata,
         .base  = jdata,
         .curr  = jdata,
+        .last  = jdata + len,
+        .flags = flags,
+        .scratch = { .data = NULL, .len = 0, .cap = 0 },
     };
+    jcsn_scanner_init(&lexer->scanner, jdata, lexer->last - jdata);
+}
 
-    char ch, *tmp = NULL, err = 0;
-    Jcsn_TList tlist = { NULL, 0, 8 };
-    tlist.tokens = malloc(sizeof(*tlist.tokens) * tlist.cap);
-    if (!tlist.tokens) {
-        err = 1;
-        goto ret;
-    }
-    Jcsn_JNumber num = { {0}, TK_NULL };
-    Jcsn_Token tk = {0};
-    enum Jcsn_Token_Type tk_type;
-
-    while (1) {
-        jcsn_skip_whitespaces(&tokenizer.base);
-        ch = *tokenizer.base;
-        if (!ch)
-            break;
-
-        if (ch == '{') {
-            tk_type = TK_OBJ_BEG;
-            tokenizer.base += 1;
-        }
-
-        else if (ch == '}') {
-            tk_type = TK_OBJ_END;
-            tokenizer.base += 1;
-        }
-
-        else if (ch == '[') {
-            tk_type = TK_ARR_BEG;
-            tokenizer.base += 1;
-        }
-
-        else if (ch == ']') {
-            tk_type = TK_ARR_END;
-            tokenizer.base += 1;
-        }
-
-        else if (ch == ',') {
-            tk_type = TK_COMMA;
-            tokenizer.base += 1;
-        }
 
-        else if (ch == ':') {
-            tk_type = TK_COLON;
-            tokenizer.base += 1;
+int jcsn_lexer_next(Jcsn_Lexer *lexer, Jcsn_Token *tk) {
+    size_t pos;
+    char ch, *tmp = NULL;
+    Jcsn_JNumber num;
+
+    // Jump to next structural position.
+    // Whitespaces and string contents are skipped by the scanner.
+    pos = jcsn_scanner_next(&lexer->scanner);
+    if (pos >= lexer->scanner.len) {
+        tk->type = TK_EOF;
+        return 0;
+    }
+    lexer->base = lexer->first + pos;
+    ch = *lexer->base;
+
+    switch (ch) {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ',':
+        case ':': {
+            // token type is the character itself
+            tk->type = (enum Jcsn_Token_Type)ch;
+            lexer->base += 1;
         }
+        return 0;
 
-        else if (ch == '\"') {
-            tk_type = TK_STRING;
-            tk = (Jcsn_Token) { .type = tk_type };
-            tk.value.string = jcsn_extract_json_string(&tokenizer.base, &tokenizer.curr);
-            if (tk.value.string == NULL) {
+        case '\"': {
+            tk->type = TK_STRING;
+            if (jcsn_extract_json_string(lexer, &tk->value.string)) {
                 JCSN_LOG_ERR("Failed to parse json string\n", NULL);
                 JCSN_LOG_ERR("Check json data syntax for errors\n", NULL);
-                xfree(tk.value.string);
-                err = 1;
-                goto ret;
+                return 1;
             }
-            goto append;
-        } // end tokenize json string
-
-        else if (ch == 'n') {
-            tk_type = TK_NULL;
-            if ((tmp = jcsn_string_starts_with(tokenizer.base, "null"))) {
-                tk = (Jcsn_Token) { .type = tk_type };
-                tokenizer.base = tmp;
-                goto append;
+        }
+        return 0;
+
+        case 'n': {
+            tk->type = TK_NULL;
+            if ((tmp = jcsn_match_literal(lexer->base, lexer->last, "null", 4))) {
+                lexer->base = tmp;
             } else {
                 JCSN_LOG_ERR("Invalid token while parsing json null\n", NULL);
                 JCSN_LOG_ERR("Token does not match with \'null\'\n", NULL);
-                err = 1;
-                goto ret;
+                return 1;
             }
-        } // end tokenize json null
-
-        else if (ch == 't' || ch == 'f') {
-            tk_type = TK_BOOL;
-            tk = (Jcsn_Token) { .type = tk_type };
-            if ((tmp = jcsn_string_starts_with(tokenizer.base, "true"))) {
-                tk.value.boolean = true;
-                tokenizer.base = tmp;
+        }
+        goto scalar;
+
+        case 't':
+        case 'f': {
+            tk->type = TK_BOOL;
+            if ((tmp = jcsn_match_literal(lexer->base, lexer->last, "true", 4))) {
+                tk->value.boolean = true;
+                lexer->base = tmp;
             }
-            else if ((tmp = jcsn_string_starts_with(tokenizer.base, "false"))) {
-                tk.value.boolean = false;
-                tokenizer.base = tmp;
+            else if ((tmp = jcsn_match_literal(lexer->base, lexer->last, "false", 5))) {
+                tk->value.boolean = false;
+                lexer->base = tmp;
             }
             else {
                 JCSN_LOG_ERR("Invalid token while parsing json boolean value\n", NULL);
                 JCSN_LOG_ERR("Token does not match with \'true\' or \'false\'\n", NULL);
-                err = 1;
-                goto ret;
+                return 1;
+            }
+        }
+        goto scalar;
+
+        default: break;
+    } // end switch (ch)
+
+    if (ch == '-' || jcsn_char_is_digit(ch)) {
+        num = jcsn_parse_json_number(&lexer->base, &lexer->curr, lexer->last,
+                                     !(lexer->flags & JCSN_LEX_VALIDATE_ONLY));
+        tk->type = num.type;
+        switch (num.type) {
+            case TK_INTEGER:
+                tk->value.integer = num.value.integer;
+                break;
+
+            case TK_REAL:
+                tk->value.real = num.value.real;
+                break;
+
+            default: {
+                JCSN_LOG_ERR("Invalid token while parsing json number value\n", NULL);
+                JCSN_LOG_ERR("Token does not match with a valid number\n", NULL);
+                return 1;
             }
-            goto append;
-        } // end tokenize json boolean
-
-        else if (ch == '+' || ch == '-' || jcsn_char_is_digit(ch)) {
-            num = jcsn_parse_json_number(&tokenizer.base, &tokenizer.curr);
-            tk_type = num.type;
-            switch (num.type) {
-                case TK_INTEGER:
-                    tk = (Jcsn_Token) { .type = tk_type };
-                    tk.value.integer = num.value.integer;
-                    break;
-
-                case TK_REAL:
-                    tk = (Jcsn_Token) { .type = tk_type };
-                    tk.value.real = num.value.real;
-                    break;
-
-                default: {
-                    JCSN_LOG_ERR("Invalid token while parsing json number value\n", NULL);
-                    JCSN_LOG_ERR("Token does not match with a valid number\n", NULL);
-                    err = 1;
-                    goto ret;
+        } // end switch(num.type)
+    } // end tokenize json number
+
+    else {
+        JCSN_LOG_ERR("Invalid character while parsing json data: %c (ascii: %d)\n", ch, ch);
+        return 1;
+    }
+
+scalar:
+    if (!jcsn_scalar_ended(lexer)) {
+        JCSN_LOG_ERR("Invalid character after json value: %c (ascii: %d)\n",
+                     *lexer->base, *lexer->base);
+        return 1;
+    }
+    return 0;
+}
+
+
+int jcsn_lexer_skip(Jcsn_Lexer *lexer, size_t *start) {
+    size_t depth = 0, pos = jcsn_scanner_next(&lexer->scanner);
+    if (pos >= lexer->scanner.len)
+        return 1;
+    *start = pos;
+
+    // string contents are never reported by scanner, so every bracket
+    // found here is a structural one
+    while (1) {
+        switch (lexer->first[pos]) {
+            case '{':
+            case '[':
+                depth += 1;
+                break;
+
+            case '}':
+            case ']':
+                if (depth == 0)
+                    return 1;
+                depth -= 1;
+                break;
+
+            case ',':
+            case ':':
+                if (depth == 0)
+                    return 1;
+                break;
+
+            default: break;
+        }
+        if (depth == 0)
+            break;
+
+        pos = jcsn_scanner_next(&lexer->scanner);
+        if (pos >= lexer->scanner.len)
+            return 1;
+    }
+
+    lexer->base = lexer->first + pos + 1;
+    return 0;
+}
+
+
+int jcsn_lexer_leave(Jcsn_Lexer *lexer) {
+    size_t depth = 0, pos;
+
+    while (1) {
+        pos = jcsn_scanner_next(&lexer->scanner);
+        if (pos >= lexer->scanner.len)
+            return 1;
+
+        switch (lexer->first[pos]) {
+            case '{':
+            case '[':
+                depth += 1;
+                break;
+
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    lexer->base = lexer->first + pos + 1;
+                    return 0;
                 }
-            } // end switch(num.type)
-            goto append;
-        } // end tokenize json number
+                depth -= 1;
+                break;
 
-        else {
-            JCSN_LOG_ERR("Invalid character while parsing json data: %c (ascii: %d)\n", ch, ch);
-            err = 1;
-            goto ret;
+            default: break;
         }
+    }
+}
 
-        tk = (Jcsn_Token) { .type = tk_type };
-append:
-        jcsn_tlist_append(&tlist, &tk);
-    } // end while loop
 
-ret:
-    if (err)
-        jcsn_tlist_free(&tlist);
-    return tlist;
+char jcsn_lexer_peek(Jcsn_Lexer *lexer) {
+    size_t pos = jcsn_scanner_peek(&lexer->scanner);
+    return (pos < lexer->scanner.len) ? lexer->first[pos] : '\0';
 }
 
 
-Jcsn_Token *jcsn_tlist_get(Jcsn_Token *tks, size_t len, long idx) {
-    return ((idx >= 0) && (idx < (long)len)) ? &tks[idx] : NULL;
+void jcsn_lexer_free(Jcsn_Lexer *lexer) {
+    if (lexer) {
+        xfree(lexer->scratch.data);
+        lexer->scratch.len = 0;
+        lexer->scratch.cap = 0;
+    }
 }
 
 #ifdef __cplusplus
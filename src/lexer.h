@@ -7,7 +7,7 @@
  *
  * ------------------------------------------------------------ *
  * Lexical Analysis Module
- * Convert raw json data into a list of tokens
+ * Convert raw json data into tokens
  * ------------------------------------------------------------ *
  *
  * Jacson is developed under MIT License. You can find a copy
@@ -24,6 +24,21 @@ extern "C" {
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <jacson/jtypes.h>
+#include "scan.h"
+#include "str.h"
+
+
+/**
+ * Macros and constants
+ */
+
+// Internal lexer flag, combined with `Jcsn_Parse_Flag` values.
+// Tokens are only checked: numbers are not converted and json strings
+// are not unescaped, so nothing is allocated and json data is never
+// modified.
+#define JCSN_LEX_VALIDATE_ONLY (1 << 15)
+
 
 
 /**
@@ -46,13 +61,16 @@ enum Jcsn_Token_Type {
     TK_REAL,
     TK_BOOL,
     TK_NULL,
+
+    // End of json data
+    TK_EOF,
 };
 
 
 // a Json Token
 typedef struct Jcsn_Token {
     union {
-        char   *string;
+        Jcsn_JString string;
         bool   boolean;
         long   integer;
         double real;
@@ -61,20 +79,67 @@ typedef struct Jcsn_Token {
 } Jcsn_Token;
 
 
-// a dynamic array to store tokens
-typedef struct Jcsn_TList {
-    Jcsn_Token *tokens;
-    unsigned long len;
-    unsigned long cap;
-} Jcsn_TList;
+// Lexer produces tokens one at a time, straight from raw json data.
+// Nothing but unescaped copies of json strings is allocated.
+typedef struct Jcsn_Lexer {
+    // Since we're working with pointer arithmic, keep a pointer to
+    // first character in json data to prevent out of bound access
+    // to memory locations if parser wants to go backward.
+    char *first;
+
+    // Pointer to base character in raw json data
+    char *base;
+
+    // Pointer to current character in raw json data
+    char *curr;
+
+    // Pointer to one past last character in raw json data
+    char *last;
+
+    // Parsing options (See `Jcsn_Parse_Flag`)
+    int flags;
+
+    // Structural positions of raw json data
+    Jcsn_Scanner scanner;
+
+    // Json strings that had escapes in them are unescaped here. Other
+    // strings point into raw json data.
+    Jcsn_String scratch;
+} Jcsn_Lexer;
+
+
+// Start lexing `len` bytes of raw json data.
+// `flags` is a combination of `Jcsn_Parse_Flag` values. Unescaped
+// strings are left in lexer's scratch buffer and are only valid until
+// next call to `jcsn_lexer_next`.
+void jcsn_lexer_init(Jcsn_Lexer *lexer, char *jdata, size_t len, int flags);
+
+// Read next token from json data into `tk`.
+// At the end of json data, `tk->type` is `TK_EOF`.
+// 0 -> ok
+// 1 -> found an invalid token
+int jcsn_lexer_next(Jcsn_Lexer *lexer, Jcsn_Token *tk);
 
+// Skip next json value and all of it's children without tokenizing
+// them. Only brackets are matched, nothing else is checked. Offset of
+// first byte of value is stored in `start`. For a json object/array,
+// `lexer->base` is left right after it's closing bracket.
+// 0 -> ok
+// 1 -> there is no json value to skip
+int jcsn_lexer_skip(Jcsn_Lexer *lexer, size_t *start);
 
-Jcsn_TList jcsn_tokenize_json(char *jdata);
+// Skip the rest of json object/array that lexer is in, up to and
+// including it's closing bracket. Nothing in between is checked.
+// 0 -> ok
+// 1 -> json object/array is not closed
+int jcsn_lexer_leave(Jcsn_Lexer *lexer);
 
-void jcsn_tlist_free(Jcsn_TList *tlist);
+// Get first character of next token without reading it ('\0' at the
+// end of json data)
+char jcsn_lexer_peek(Jcsn_Lexer *lexer);
 
-// get a token from token list
-Jcsn_Token *jcsn_tlist_get(Jcsn_Token *tks, size_t len, long idx);
+// Free scratch buffer of lexer
+void jcsn_lexer_free(Jcsn_Lexer *lexer);
 
 
 #ifdef __cplusplus
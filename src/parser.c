@@ -7,7 +7,7 @@
  *
  * ------------------------------------------------------------ *
  * Parser Module
- * Parse tokens into an AST.
+ * Parse json data into an AST.
  * ------------------------------------------------------------ *
  *
  * Jacson is developed under MIT License. You can find a copy
@@ -30,14 +30,19 @@ extern "C" {
     #include <stdio.h>
 #endif // __JCSN_TRACE__
 #include <stdlib.h>
+#include <string.h>
 
 // Jacson
 #include "log.h"
 #include "mem.h"
 #include "lexer.h"
 #include "validator.h"
+#include "str.h"
 #include "jvalue.h"
+#include "intern.h"
+#include "shape.h"
 #include "parser.h"
+#include <jacson/jacson.h>
 
 
 
@@ -46,20 +51,26 @@ extern "C" {
  */
 
 typedef struct Jcsn_Parser {
-    // Pointer to previous token
-    Jcsn_Token *prev;
+    // Source of tokens
+    Jcsn_Lexer lexer;
 
-    // Pointer to current token
-    Jcsn_Token *curr;
+    // Checks tokens against json grammar before they are used
+    Jcsn_Validator validator;
 
-    // Pointer to next token
-    Jcsn_Token *next;
+    // Current token
+    Jcsn_Token curr;
 
-    // Current data collection that we append data to it.
-    // A data collection in json is either a json object or a json array.
-    // Just keep a pointer to it, to know where we add the parsed data.
-    // It's like scope in programming languages.
-    Jcsn_JValue *scope;
+    // Values of json objects/arrays that are not closed yet. Members of
+    // a json object are pushed as a name followed by it's value.
+    Jcsn_Pool stack;
+
+    // Where values of each open json object/array start in `stack`.
+    // It's like scopes in programming languages.
+    size_t scopes[JCSN_MAX_DEPTH];
+    size_t depth;
+
+    // Shapes of json objects parsed so far
+    Jcsn_Shapes shapes;
 } Jcsn_Parser;
 
 
@@ -68,28 +79,147 @@ typedef struct Jcsn_Parser {
  * Module Private API
  */
 
-// stat = 1 -> OK
-// stat = 0 -> ERROR
-static Jcsn_JValue *jcsn_handle_jvalue(Jcsn_Parser *parser, Jcsn_JValue *value) {
-    Jcsn_JValue *addr = NULL;
-    if (!parser->scope) {
-        if (value->type == J_OBJECT || value->type == J_ARRAY) {
-            parser->scope = value;
-            addr = value;
+// Place member names of a json object (every other node of `names`),
+// unless an earlier json object has the same names in the same order.
+// Then those names and their hash index are shared.
+static int jcsn_place_names(Jcsn_Parser *parser,
+                            Jcsn_Pool *pool,
+                            const Jcsn_JValue *names,
+                            size_t n,
+                            Jcsn_JValue *obj)
+{
+    uint32_t hash = 0;
+    int64_t shared = -1;
+
+    if (n >= JCSN_JOBJ_INDEX_MIN)
+        obj->flags = JCSN_JVAL_INDEXED;
+    if (n) {
+        hash = jcsn_shape_hash(names, n, 2);
+        shared = jcsn_shapes_find(&parser->shapes, pool, names, n, 2, hash);
+    }
+    if (shared >= 0) {
+        obj->data.kids.names = (int32_t)shared;
+        return 0;
+    }
+
+    if ((obj->flags & JCSN_JVAL_INDEXED) && jcsn_pool_index(pool, n))
+        return 1;
+    obj->data.kids.names = (int32_t)pool->len;
+    if (jcsn_pool_place(pool, names, n, 2))
+        return 1;
+    return n && jcsn_shapes_add(&parser->shapes, hash, n, (size_t)obj->data.kids.names);
+}
+
+
+// Type of elements of a json array that can be packed: J_INTEGER if all
+// of them are integers and J_REAL if all of them are reals. J_NULL
+// otherwise (or if it's empty).
+static enum Jcsn_JVal_T jcsn_numbers_type(const Jcsn_JValue *vals, size_t n) {
+    if (n == 0 || (vals[0].type != J_INTEGER && vals[0].type != J_REAL))
+        return J_NULL;
+    for (size_t i = 1; i < n; i++)
+        if (vals[i].type != vals[0].type)
+            return J_NULL;
+    return (enum Jcsn_JVal_T)vals[0].type;
+}
+
+
+// Move values of current scope into AST, next to each other, and replace
+// them in stack with the json object/array that owns them.
+static int jcsn_close_scope(Jcsn_Parser *parser, Jcsn_Pool *pool, enum Jcsn_JVal_T type) {
+    size_t start = parser->scopes[--parser->depth];
+    Jcsn_JValue *vals = &parser->stack.nodes[start];
+    size_t n = parser->stack.len - start;
+    Jcsn_JValue coll = {
+        .type = type,
+        .flags = 0,
+        .len = 0,
+        .data.kids = { .names = 0, .vals = 0 },
+    };
+
+    if (type == J_OBJECT) {
+        n >>= 1;
+        if (jcsn_place_names(parser, pool, vals, n, &coll))
+            return 1;
+        vals += 1;
+    } else if (parser->lexer.flags & JCSN_PARSE_PACK_NUMBERS) {
+        int64_t at = -1;
+        switch (jcsn_numbers_type(vals, n)) {
+            case J_INTEGER:
+                at = jcsn_pool_pack(pool, vals, n, J_INTEGER);
+                coll.flags = JCSN_JVAL_LONGS;
+                break;
+            case J_REAL:
+                at = jcsn_pool_pack(pool, vals, n, J_REAL);
+                coll.flags = JCSN_JVAL_DOUBLES;
+                break;
+            default:
+                goto place;
         }
-        goto ret;
+        if (at < 0)
+            return 1;
+        coll.data.kids.vals = (int32_t)at;
+        goto push;
     }
 
-    value->parent = parser->scope;
-    if (parser->scope->type == J_OBJECT)
-        if (parser->prev->type == ':')
-            addr = jcsn_jobj_set_value(&parser->scope->data.object, value);
-        else
-            goto ret;
-    else if (parser->scope->type == J_ARRAY)
-        addr = jcsn_jarr_append(&parser->scope->data.array, value);
-ret:
-    return addr;
+place:
+    coll.data.kids.vals = (int32_t)pool->len;
+    if (jcsn_pool_place(pool, vals, n, (type == J_OBJECT) ? 2 : 1))
+        return 1;
+
+push:
+    coll.len = (uint32_t)n;
+
+    parser->stack.len = start;
+    return jcsn_pool_push(&parser->stack, &coll);
+}
+
+
+// Turn a json string token into a node. Member names of json objects
+// are interned: an equal name seen before is reused instead.
+static int jcsn_string_node(Jcsn_Parser *parser, Jcsn_AST *ast, Jcsn_JValue *val, bool name) {
+    Jcsn_JString s = parser->curr.value.string;
+    const Jcsn_Intern_Slot *slot = NULL;
+    uint32_t hash = 0;
+
+    if (s.len > UINT32_MAX) {
+        JCSN_LOG_ERR("Json string is too long\n", NULL);
+        return 1;
+    }
+
+    val->type = J_STRING;
+    val->len = (uint32_t)s.len;
+    if (name) {
+        hash = jcsn_string_hash(s.data, s.len);
+        slot = jcsn_intern_find(&ast->names, &ast->pool, s.data, s.len, hash);
+        if (slot) {
+            if (slot->str) {
+                val->data.str = slot->str;
+            } else {
+                val->flags = JCSN_JVAL_POOLED;
+                val->data.off = slot->off;
+            }
+            return 0;
+        }
+    }
+
+    if (s.data != parser->lexer.scratch.data) {
+        val->data.str = s.data;
+    } else {
+        // unescaped strings in lexer's scratch buffer are overwritten by
+        // next token
+        int64_t off = jcsn_pool_strndup(&ast->pool, s.data, s.len);
+        if (off < 0)
+            return 1;
+        val->flags = JCSN_JVAL_POOLED;
+        val->data.off = off;
+    }
+
+    if (name && jcsn_intern_add(&ast->names, hash, s.len,
+                                (val->flags & JCSN_JVAL_POOLED) ? NULL : val->data.str,
+                                (val->flags & JCSN_JVAL_POOLED) ? val->data.off : 0))
+        return 1;
+    return 0;
 }
 
 
@@ -98,183 +228,142 @@ ret:
  * Module Public API
  */
 
-// Parse json data from bytes into an AST
-Jcsn_AST *jcsn_parser_parse_raw(char *jdata) {
-    Jcsn_TList tlist = jcsn_tokenize_json(jdata);
-    if (!tlist.tokens) {
-        JCSN_LOG_ERR("Failed to tokenize json data\n", NULL);
-        return NULL;
-    }
+// Parse json data from bytes into an AST.
+// Tokens are pulled from lexer, validated and added to AST in a single
+// pass. AST is built bottom-up: a json object/array is added to it when
+// it's closed, after all of it's children.
+Jcsn_AST *jcsn_parser_parse_raw(char *jdata, int flags) {
+    return jcsn_parser_parse_span(jdata, strlen(jdata), flags);
+}
 
-    if (!jcsn_validate_tokens(&tlist)) {
-        JCSN_LOG_ERR("Provided json data is not valid\n", NULL);
-        JCSN_LOG_INF("Returning NULL\n", NULL);
-        return NULL;
-    }
 
-    size_t len = tlist.len, i;
-    Jcsn_JValue *val = NULL;
-    Jcsn_Token *tks = tlist.tokens;
+Jcsn_AST *jcsn_parser_parse_span(char *jdata, size_t len, int flags) {
+    Jcsn_JValue val;
     Jcsn_Parser parser = { 0 };
 
     Jcsn_AST *ast = malloc(sizeof(*ast));
-    if (!ast) {
-        goto ret;
+    if (!ast)
+        return NULL;
+    jcsn_intern_init(&ast->names);
+    // there is about one json value for every 8 bytes of json data
+    if (jcsn_pool_init(&ast->pool, len / 8)) {
+        xfree(ast);
+        return NULL;
     }
-    *ast = (Jcsn_AST) {
-        .root = NULL,
-        .depth = 0,
-    };
-
 
-    for (i = 0; i < len; i++) {
-        parser.prev = jcsn_tlist_get(tks, len, i-1);
-        parser.curr = jcsn_tlist_get(tks, len, i);
-        parser.next = jcsn_tlist_get(tks, len, i+1);
-
-        switch (parser.curr->type) {
-            case '{': {
-                val = jcsn_jobj_new();
-                parser.scope = jcsn_handle_jvalue(&parser, val);
-                ast->depth += 1;
-            }
-            break;
+    jcsn_lexer_init(&parser.lexer, jdata, len, flags);
+    jcsn_validator_init(&parser.validator);
+    jcsn_shapes_init(&parser.shapes);
+    if (jcsn_pool_init(&parser.stack, 64))
+        goto err;
 
+    while (1) {
+        if (jcsn_lexer_next(&parser.lexer, &parser.curr))
+            goto err;
+        if (!jcsn_validator_feed(&parser.validator, parser.curr.type))
+            goto err;
+
+        val = (Jcsn_JValue) { .type = J_NULL, .flags = 0, .len = 0 };
+        switch (parser.curr.type) {
+            case '{':
             case '[': {
-                val = jcsn_jarr_new();
-                parser.scope = jcsn_handle_jvalue(&parser, val);
-                ast->depth += 1;
+                // validator makes sure depth is never more than `JCSN_MAX_DEPTH`
+                parser.scopes[parser.depth++] = parser.stack.len;
             }
-            break;
+            continue;
 
             case '}':
             case ']': {
-                if (!parser.scope->parent) {
-                    ast->root = parser.scope;
-                    goto ret;
-                }
-                parser.scope = parser.scope->parent;
+                if (jcsn_close_scope(&parser, &ast->pool,
+                                     (parser.curr.type == '}') ? J_OBJECT : J_ARRAY))
+                    goto err;
             }
-            break;
+            continue;
 
             case TK_STRING: {
-                if (parser.scope->type == J_OBJECT) { 
-                    if (parser.next->type == ':')
-                        jcsn_jobj_add_name(&parser.scope->data.object, parser.curr->value.string);
-                    else {
-                        val = jcsn_jstr_new(parser.curr->value.string);
-                        jcsn_handle_jvalue(&parser, val);
-                    }
-                } else if (parser.scope->type == J_ARRAY) {
-                    val = jcsn_jval_new(J_STRING);
-                    val->parent = parser.scope;
-                    val->data.string = parser.curr->value.string;
-                    jcsn_handle_jvalue(&parser, val);
-                }
+                // validator expects a ':' only after a json object member
+                // name. Member names are pushed like values.
+                if (jcsn_string_node(&parser, ast, &val,
+                                     parser.validator.expect == JCSN_EXPECT_COLON))
+                    goto err;
             }
             break;
 
             case TK_BOOL: {
-                val = jcsn_jval_new(J_BOOL);
-                val->data.boolean = parser.curr->value.boolean;
-                jcsn_handle_jvalue(&parser, val);
+                val.type = J_BOOL;
+                val.data.boolean = parser.curr.value.boolean;
             }
             break;
 
-            case TK_NULL: {
-                val = jcsn_jval_new(J_NULL);
-                jcsn_handle_jvalue(&parser, val);
-            }
-            break;
+            case TK_NULL:
+                break;
 
             case TK_INTEGER: {
-                val = jcsn_jval_new(J_INTEGER);
-                val->data.integer = parser.curr->value.integer;
-                jcsn_handle_jvalue(&parser, val);
+                val.type = J_INTEGER;
+                val.data.integer = parser.curr.value.integer;
             }
             break;
 
             case TK_REAL: {
-                val = jcsn_jval_new(J_REAL);
-                val->data.real = parser.curr->value.real;
-                jcsn_handle_jvalue(&parser, val);
+                val.type = J_REAL;
+                val.data.real = parser.curr.value.real;
             }
             break;
 
-            default: break;
-        } // end switch (curr->type)
-    } // end for loop
-
-ret:
-    xfree(tlist.tokens);
+            case TK_EOF:
+                goto done;
+
+            default:
+                continue;
+        } // end switch (curr.type)
+
+        if (jcsn_pool_push(&parser.stack, &val))
+            goto err;
+    } // end while loop
+
+done:
+    // validator accepts one value as root and nothing after it
+    if (jcsn_pool_place(&ast->pool, parser.stack.nodes, 1, 1))
+        goto err;
+    // nodes refer to each other by offsets, so AST can move
+    jcsn_pool_shrink(&ast->pool);
+    jcsn_pool_free(&parser.stack);
+    jcsn_shapes_free(&parser.shapes);
+    jcsn_lexer_free(&parser.lexer);
     return ast;
+
+err:
+    JCSN_LOG_ERR("Provided json data is not valid\n", NULL);
+    JCSN_LOG_INF("Returning NULL\n", NULL);
+    jcsn_pool_free(&parser.stack);
+    jcsn_shapes_free(&parser.shapes);
+    jcsn_lexer_free(&parser.lexer);
+    jcsn_ast_free(ast);
+    return NULL;
+}
+
+
+Jcsn_JValue *jcsn_ast_get_root(Jcsn_AST *ast) {
+    return &ast->pool.nodes[ast->pool.len - 1];
+}
+
+
+Jcsn_JString jcsn_ast_intern(Jcsn_AST *ast, const char *name, size_t len) {
+    const Jcsn_Intern_Slot *slot = jcsn_intern_find(&ast->names, &ast->pool, name, len,
+                                                    jcsn_string_hash(name, len));
+    if (!slot)
+        return (Jcsn_JString) { .data = NULL, .len = 0 };
+    return (Jcsn_JString) { .data = jcsn_intern_string(slot, &ast->pool), .len = len };
 }
 
 
+// Everything in AST is in it's pool, so it's freed at once
 void jcsn_ast_free(Jcsn_AST *ast) {
     if (!ast)
         return;
 
-    long i = 0;
-    Jcsn_JArray *arr = NULL;
-    Jcsn_JObject *obj = NULL;
-    Jcsn_JValue *scope = ast->root, *curr = NULL, *parent = NULL;
-
-    // Free AST without recursion
-again:
-    while (1) {
-        if (scope->type == J_OBJECT) {
-            // handle json object
-            obj = &scope->data.object;
-            while ((i = (long)(obj->len -= 1), i >= 0)) {
-                xfree(obj->names[i]);
-                curr = &obj->values[i];
-                switch (curr->type) {
-                    case J_OBJECT:
-                    case J_ARRAY:
-                        scope = curr;
-                        goto again;
-                        break;
-
-                    case J_STRING:
-                        xfree(curr->data.string);
-
-                    default:
-                        break;
-                } // end switch (curr->type)
-            } // end while loop
-            xfree(obj->values);
-            xfree(obj->names);
-            parent = scope->parent;
-            scope = parent;
-        } else {
-            // handle json array
-            arr = &scope->data.array;
-            while ((i = (long)(arr->len -= 1), i >= 0)) {
-                curr = &arr->vals[i];
-                switch (curr->type) {
-                    case J_OBJECT:
-                    case J_ARRAY:
-                        scope = curr;
-                        goto again;
-                        break;
-
-                    case J_STRING:
-                        xfree(curr->data.string);
-
-                    default:
-                        break;
-                } // end switch (curr->type)
-            } // end while loop
-            xfree(arr->vals);
-            parent = scope->parent;
-            scope = parent;
-        }
-
-        if (!scope)
-            break;
-    } // end while (scope)
-    xfree(ast->root);
+    jcsn_pool_free(&ast->pool);
+    jcsn_intern_free(&ast->names);
     xfree(ast);
 }
 
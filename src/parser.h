@@ -22,6 +22,11 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stddef.h>
+#include <jacson/jtypes.h>
+#include "jvalue.h"
+#include "intern.h"
+
 
 
 /**
@@ -29,10 +34,12 @@ extern "C" {
  */
 
 typedef struct Jcsn_AST {
-    // Root of AST.
-    // It can be either a Json Object or Json Array
-    Jcsn_JValue *root;
-    unsigned long depth;
+    // Every value of AST and every unescaped string. Root is the last
+    // node. All other strings point into raw json data.
+    Jcsn_Pool pool;
+
+    // Member names of json objects. Equal names share one address.
+    Jcsn_Intern names;
 } Jcsn_AST;
 
 
@@ -42,7 +49,16 @@ typedef struct Jcsn_AST {
  */
 
 // Parse json data from bytes into an AST
-Jcsn_AST *jcsn_parser_parse_raw(char *jdata);
+Jcsn_AST *jcsn_parser_parse_raw(char *jdata, int flags);
+
+// Parse `len` bytes of json data (not null terminated) into an AST
+Jcsn_AST *jcsn_parser_parse_span(char *jdata, size_t len, int flags);
+
+// Root of AST. Any json value can be the root.
+Jcsn_JValue *jcsn_ast_get_root(Jcsn_AST *ast);
+
+// Get canonical address of a json object member name (See `jcsn_intern`)
+Jcsn_JString jcsn_ast_intern(Jcsn_AST *ast, const char *name, size_t len);
 
 // Free all memory used by ast
 void jcsn_ast_free(Jcsn_AST *ast);
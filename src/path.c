@@ -0,0 +1,639 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * JSONPath Module
+ * Get every json value that matches a JSONPath expression
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+// Jacson
+#include "log.h"
+#include "str.h"
+#include "mem.h"
+#include "jvalue.h"
+#include "path.h"
+#include <jacson/jacson.h>
+
+
+
+/**
+ * Macros and constants
+ */
+
+// Largest integer of a JSONPath (2^53 - 1)
+#define JCSN_PATH_INT_MAX 9007199254740991L
+
+
+
+/**
+ * Types
+ */
+
+// State of compiling a JSONPath. Keys and names are taken from the
+// free space of compiled path's block.
+typedef struct Jcsn_Path_Parser {
+    const char *p;
+    Jcsn_Path_Key *keys;
+    char *strs;
+} Jcsn_Path_Parser;
+
+
+
+/**
+ * Module Private API
+ */
+
+static void jcsn_path_skip_ws(Jcsn_Path_Parser *pp) {
+    while (*pp->p == ' ' || *pp->p == '\t')
+        pp->p++;
+}
+
+
+// Copy a name of `len` bytes into compiled path and make `key` refer to it
+static void jcsn_path_key_name(Jcsn_Path_Parser *pp, Jcsn_Path_Key *key, const char *name, size_t len) {
+    memcpy(pp->strs, name, len);
+    pp->strs[len] = '\0';
+    *key = (Jcsn_Path_Key) {
+        .name = pp->strs,
+        .len = len,
+        .hash = jcsn_string_hash(pp->strs, len),
+    };
+    pp->strs += len + 1;
+}
+
+
+// Read an unquoted name that ends before any character of `stop`
+static int jcsn_path_name(Jcsn_Path_Parser *pp, const char *stop, Jcsn_Path_Key *key) {
+    size_t len = strcspn(pp->p, stop);
+    if (len == 0)
+        return 1;
+
+    jcsn_path_key_name(pp, key, pp->p, len);
+    pp->p += len;
+    return 0;
+}
+
+
+// Read a string in single or double quotes. A backslash escapes the
+// character after it. Unescaped string is copied into compiled path.
+static int jcsn_path_quoted(Jcsn_Path_Parser *pp, char **str, size_t *len) {
+    char quote = *pp->p++, *dst = pp->strs;
+
+    while (*pp->p && *pp->p != quote) {
+        if (*pp->p == '\\' && pp->p[1])
+            pp->p++;
+        *dst++ = *pp->p++;
+    }
+    if (*pp->p != quote)
+        return 1;
+    pp->p++;
+
+    *str = pp->strs;
+    *len = (size_t)(dst - pp->strs);
+    *dst++ = '\0';
+    pp->strs = dst;
+    return 0;
+}
+
+
+// Read an optionally negative integer. Like in RFC 9535, integers out
+// of range of I-JSON (-2^53 + 1 .. 2^53 - 1) are rejected.
+static int jcsn_path_long(Jcsn_Path_Parser *pp, long *n) {
+    const char *s = pp->p;
+    char *end;
+    long v;
+
+    if (*s == '-')
+        s++;
+    if (!jcsn_char_is_digit(*s))
+        return 1;
+
+    errno = 0;
+    v = strtol(pp->p, &end, 10);
+    if (errno == ERANGE || v > JCSN_PATH_INT_MAX || v < -JCSN_PATH_INT_MAX)
+        return 1;
+
+    *n = v;
+    pp->p = end;
+    return 0;
+}
+
+
+// Read a name in quotes or an index inside `[]` of a filter path
+static int jcsn_path_filter_key(Jcsn_Path_Parser *pp, Jcsn_Path_Key *key) {
+    char *name;
+    size_t len;
+
+    jcsn_path_skip_ws(pp);
+    if (*pp->p == '\'' || *pp->p == '"') {
+        if (jcsn_path_quoted(pp, &name, &len))
+            return 1;
+        *key = (Jcsn_Path_Key) {
+            .name = name,
+            .len = len,
+            .hash = jcsn_string_hash(name, len),
+        };
+    } else {
+        *key = (Jcsn_Path_Key) { .name = NULL };
+        if (jcsn_path_long(pp, &key->idx))
+            return 1;
+    }
+
+    jcsn_path_skip_ws(pp);
+    if (*pp->p != ']')
+        return 1;
+    pp->p++;
+    return 0;
+}
+
+
+static int jcsn_path_literal(Jcsn_Path_Parser *pp, Jcsn_JValue *lit) {
+    const char *s = pp->p;
+    char *end, *str;
+    size_t len;
+
+    *lit = (Jcsn_JValue) { .type = J_NULL };
+    if (*s == '\'' || *s == '"') {
+        if (jcsn_path_quoted(pp, &str, &len))
+            return 1;
+        lit->type = J_STRING;
+        lit->len = (uint32_t)len;
+        lit->data.str = str;
+    } else if (jcsn_string_starts_with(s, "true")) {
+        lit->type = J_BOOL;
+        lit->data.boolean = true;
+        pp->p += 4;
+    } else if (jcsn_string_starts_with(s, "false")) {
+        lit->type = J_BOOL;
+        lit->data.boolean = false;
+        pp->p += 5;
+    } else if (jcsn_string_starts_with(s, "null")) {
+        pp->p += 4;
+    } else {
+        if (*s == '-')
+            s++;
+        if (!jcsn_char_is_digit(*s))
+            return 1;
+        lit->type = J_INTEGER;
+        lit->data.integer = strtol(pp->p, &end, 10);
+        if (*end == '.' || *end == 'e' || *end == 'E') {
+            lit->type = J_REAL;
+            lit->data.real = strtod(pp->p, &end);
+        }
+        pp->p = end;
+    }
+    return 0;
+}
+
+
+// Read a filter after `[?`: `(@.a.b <op> literal)`. Parentheses are
+// optional and without `<op> literal` the filter checks that `@.a.b`
+// exists.
+static int jcsn_path_filter(Jcsn_Path_Parser *pp, Jcsn_Path_Step *st) {
+    static const struct { const char *op; enum Jcsn_Path_Cmp cmp; } ops[] = {
+        { "==", C_EQ }, { "!=", C_NE }, { "<=", C_LE },
+        { ">=", C_GE }, { "<", C_LT }, { ">", C_GT },
+    };
+    Jcsn_Path_Key *keys = pp->keys;
+    size_t n = 0, i;
+    bool paren;
+
+    jcsn_path_skip_ws(pp);
+    paren = (*pp->p == '(');
+    if (paren) {
+        pp->p++;
+        jcsn_path_skip_ws(pp);
+    }
+    if (*pp->p != '@')
+        return 1;
+    pp->p++;
+
+    for (;;) {
+        if (*pp->p == '.') {
+            pp->p++;
+            if (jcsn_path_name(pp, " \t.[]()=!<>", &keys[n]))
+                return 1;
+        } else if (*pp->p == '[') {
+            pp->p++;
+            if (jcsn_path_filter_key(pp, &keys[n]))
+                return 1;
+        } else {
+            break;
+        }
+        n += 1;
+    }
+    pp->keys += n;
+
+    st->op = P_FILTER;
+    st->u.filter.keys = keys;
+    st->u.filter.len = n;
+    st->u.filter.cmp = C_EXISTS;
+
+    jcsn_path_skip_ws(pp);
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        if (jcsn_string_starts_with(pp->p, ops[i].op)) {
+            st->u.filter.cmp = ops[i].cmp;
+            pp->p += strlen(ops[i].op);
+            jcsn_path_skip_ws(pp);
+            if (jcsn_path_literal(pp, &st->u.filter.literal))
+                return 1;
+            break;
+        }
+    }
+
+    jcsn_path_skip_ws(pp);
+    if (paren) {
+        if (*pp->p != ')')
+            return 1;
+        pp->p++;
+    }
+    return 0;
+}
+
+
+// Read a selector after `[` up to and including it's `]`
+static int jcsn_path_bracket(Jcsn_Path_Parser *pp, Jcsn_Path_Step *st) {
+    char *name;
+    size_t len;
+    long n = 0;
+
+    jcsn_path_skip_ws(pp);
+    if (*pp->p == '*') {
+        pp->p++;
+        st->op = P_WILDCARD;
+    } else if (*pp->p == '\'' || *pp->p == '"') {
+        if (jcsn_path_quoted(pp, &name, &len))
+            return 1;
+        st->op = P_NAME;
+        st->u.key = (Jcsn_Path_Key) {
+            .name = name,
+            .len = len,
+            .hash = jcsn_string_hash(name, len),
+        };
+    } else if (*pp->p == '?') {
+        pp->p++;
+        if (jcsn_path_filter(pp, st))
+            return 1;
+    } else {
+        // [N] or [start:end:step]
+        st->u.slice.has_start = !jcsn_path_long(pp, &n);
+        st->u.slice.start = n;
+        jcsn_path_skip_ws(pp);
+        if (*pp->p != ':') {
+            if (!st->u.slice.has_start)
+                return 1;
+            st->op = P_INDEX;
+            st->u.key = (Jcsn_Path_Key) { .name = NULL, .idx = n };
+        } else {
+            pp->p++;
+            jcsn_path_skip_ws(pp);
+            st->op = P_SLICE;
+            st->u.slice.has_end = !jcsn_path_long(pp, &st->u.slice.end);
+            st->u.slice.step = 1;
+            jcsn_path_skip_ws(pp);
+            if (*pp->p == ':') {
+                pp->p++;
+                jcsn_path_skip_ws(pp);
+                (void)jcsn_path_long(pp, &st->u.slice.step);
+            }
+        }
+    }
+
+    jcsn_path_skip_ws(pp);
+    if (*pp->p != ']')
+        return 1;
+    pp->p++;
+    return 0;
+}
+
+
+// Read a selector after `.`: `*` or a name
+static int jcsn_path_dotted(Jcsn_Path_Parser *pp, Jcsn_Path_Step *st) {
+    if (*pp->p == '*') {
+        pp->p++;
+        st->op = P_WILDCARD;
+        return 0;
+    }
+    st->op = P_NAME;
+    return jcsn_path_name(pp, ".[", &st->u.key);
+}
+
+
+static size_t jcsn_path_len(const Jcsn_JValue *val) {
+    if (val->type == J_OBJECT)
+        return jcsn_jobj_len(val);
+    if (val->type == J_ARRAY)
+        return jcsn_jarr_len(val);
+    return 0;
+}
+
+
+// Get child at `idx` of a json object/array (NULL for elements of packed
+// json arrays)
+static const Jcsn_JValue *jcsn_path_child(const Jcsn_JValue *val, size_t idx) {
+    if (val->type == J_OBJECT)
+        return jcsn_jobj_value(val, idx);
+    return jcsn_jarr_get(val, idx);
+}
+
+
+static const Jcsn_JValue *jcsn_path_key(const Jcsn_JValue *val, const Jcsn_Path_Key *key) {
+    long idx;
+
+    if (key->name)
+        return jcsn_jobj_find(val, key->name, key->len, key->hash);
+    if (val->type != J_ARRAY)
+        return NULL;
+
+    idx = (key->idx < 0) ? key->idx + (long)jcsn_jarr_len(val) : key->idx;
+    return (idx >= 0) ? jcsn_jarr_get(val, (size_t)idx) : NULL;
+}
+
+
+// Compare a json value to literal of a filter. Numbers compare by value
+// whatever their type. Strings compare bytewise. Booleans and nulls are
+// only equal or not. Values of different types are never equal.
+static bool jcsn_path_compare(const Jcsn_JValue *a, enum Jcsn_Path_Cmp cmp, const Jcsn_JValue *b) {
+    bool a_num = (a->type == J_INTEGER || a->type == J_REAL);
+    bool b_num = (b->type == J_INTEGER || b->type == J_REAL);
+    Jcsn_JString sa, sb;
+    double x, y;
+    bool eq;
+    int c;
+
+    if (a_num && b_num) {
+        if (a->type == J_INTEGER && b->type == J_INTEGER) {
+            c = (a->data.integer > b->data.integer) - (a->data.integer < b->data.integer);
+        } else {
+            x = (a->type == J_INTEGER) ? (double)a->data.integer : a->data.real;
+            y = (b->type == J_INTEGER) ? (double)b->data.integer : b->data.real;
+            c = (x > y) - (x < y);
+        }
+    } else if (a->type == J_STRING && b->type == J_STRING) {
+        sa = jcsn_jval_string(a);
+        sb = jcsn_jval_string(b);
+        c = memcmp(sa.data, sb.data, (sa.len < sb.len) ? sa.len : sb.len);
+        if (c == 0)
+            c = (sa.len > sb.len) - (sa.len < sb.len);
+    } else {
+        eq = (a->type == b->type)
+            && (a->type == J_NULL || (a->type == J_BOOL && a->data.boolean == b->data.boolean));
+        if (cmp == C_NE)
+            return !eq;
+        return eq && (cmp == C_EQ || cmp == C_LE || cmp == C_GE);
+    }
+
+    switch (cmp) {
+    case C_EQ: return c == 0;
+    case C_NE: return c != 0;
+    case C_LT: return c < 0;
+    case C_LE: return c <= 0;
+    case C_GT: return c > 0;
+    case C_GE: return c >= 0;
+    default: return true;
+    }
+}
+
+
+static bool jcsn_path_match(const Jcsn_Path_Step *st, const Jcsn_JValue *val) {
+    for (size_t i = 0; i < st->u.filter.len && val; i++)
+        val = jcsn_path_key(val, &st->u.filter.keys[i]);
+
+    // a missing value (Nothing in RFC 9535) only differs from a literal
+    if (!val)
+        return st->u.filter.cmp == C_NE;
+    if (st->u.filter.cmp == C_EXISTS)
+        return true;
+    return jcsn_path_compare(val, st->u.filter.cmp, &st->u.filter.literal);
+}
+
+
+// Get number of elements a slice picks from a json array of `n` elements
+// and index of first one of them (RFC 9535, 2.3.4.2.2). Counts are
+// computed unsigned, so a step as large as the array can't overflow.
+static size_t jcsn_path_slice(const Jcsn_Path_Step *st, long n, long *first) {
+    long step = st->u.slice.step, start, end, lo, hi;
+
+    if (step == 0)
+        return 0;
+
+    start = st->u.slice.start;
+    end = st->u.slice.end;
+    if (step > 0) {
+        start = (!st->u.slice.has_start) ? 0 : (start < 0) ? n + start : start;
+        end = (!st->u.slice.has_end) ? n : (end < 0) ? n + end : end;
+        lo = (start < 0) ? 0 : (start > n) ? n : start;
+        hi = (end < 0) ? 0 : (end > n) ? n : end;
+        *first = lo;
+        return (hi > lo) ? (size_t)((unsigned long)(hi - lo - 1) / (unsigned long)step) + 1 : 0;
+    }
+
+    start = (!st->u.slice.has_start) ? n - 1 : (start < 0) ? n + start : start;
+    end = (!st->u.slice.has_end) ? -1 : (end < 0) ? n + end : end;
+    hi = (start < -1) ? -1 : (start > n - 1) ? n - 1 : start;
+    lo = (end < -1) ? -1 : (end > n - 1) ? n - 1 : end;
+    *first = hi;
+    return (hi > lo) ? (size_t)((unsigned long)(hi - lo - 1) / (0UL - (unsigned long)step)) + 1 : 0;
+}
+
+
+// Get number of children of `val` that selector of `st` looks at.
+// For a slice, `first` is set to index of first one.
+static size_t jcsn_path_candidates(const Jcsn_Path_Step *st, const Jcsn_JValue *val, long *first) {
+    switch (st->op) {
+    case P_NAME:
+        return val->type == J_OBJECT;
+    case P_INDEX:
+        return val->type == J_ARRAY;
+    case P_WILDCARD:
+    case P_FILTER:
+        return jcsn_path_len(val);
+    case P_SLICE:
+        if (val->type != J_ARRAY)
+            return 0;
+        return jcsn_path_slice(st, (long)jcsn_jarr_len(val), first);
+    }
+    return 0;
+}
+
+
+// Get candidate at `pos` if selector of `st` picks it (NULL otherwise)
+static const Jcsn_JValue *jcsn_path_candidate(const Jcsn_Path_Step *st,
+                                              const Jcsn_JValue *val,
+                                              long first,
+                                              size_t pos)
+{
+    const Jcsn_JValue *child;
+
+    switch (st->op) {
+    case P_NAME:
+    case P_INDEX:
+        return jcsn_path_key(val, &st->u.key);
+    case P_WILDCARD:
+        return jcsn_path_child(val, pos);
+    case P_SLICE:
+        return jcsn_jarr_get(val, (size_t)(first + (long)pos * st->u.slice.step));
+    case P_FILTER:
+        child = jcsn_path_child(val, pos);
+        return (child && jcsn_path_match(st, child)) ? child : NULL;
+    }
+    return NULL;
+}
+
+
+static void jcsn_path_push(Jcsn_PathIter *it, const Jcsn_JValue *val, size_t step) {
+    // Parsed json data is never nested deep enough to overflow
+    if (it->depth == JCSN_PATH_MAX_FRAMES)
+        return;
+
+    it->frames[it->depth].val = val;
+    it->frames[it->depth].pos = 0;
+    it->frames[it->depth].step = (uint32_t)step;
+    it->depth += 1;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+Jcsn_Path *jcsn_path_compile(const char *path) {
+    // Every step, key and name takes at least one character of `path`
+    size_t max = strlen(path) + 1;
+    Jcsn_Path_Parser pp;
+    Jcsn_Path_Step *st;
+    Jcsn_Path *jp;
+    bool rooted;
+    int err;
+
+    jp = malloc(sizeof(*jp) + (sizeof(Jcsn_Path_Step) + sizeof(Jcsn_Path_Key) + 2) * max);
+    if (!jp) {
+        JCSN_LOG_ERR("Failed to allocate memory for JSONPath\n", NULL);
+        return NULL;
+    }
+    jp->len = 0;
+    jp->steps = (Jcsn_Path_Step*)(jp + 1);
+
+    pp = (Jcsn_Path_Parser) {
+        .p = path,
+        .keys = (Jcsn_Path_Key*)(jp->steps + max),
+    };
+    pp.strs = (char*)(pp.keys + max);
+
+    rooted = (*pp.p == '$');
+    if (rooted)
+        pp.p++;
+
+    while (*pp.p) {
+        st = &jp->steps[jp->len];
+        *st = (Jcsn_Path_Step) { .op = P_NAME };
+
+        if (pp.p[0] == '.' && pp.p[1] == '.') {
+            st->descent = true;
+            pp.p += 2;
+        } else if (pp.p[0] == '.') {
+            pp.p += 1;
+        } else if (pp.p[0] != '[' && (rooted || jp->len > 0)) {
+            goto err;
+        }
+
+        // `.[N]` is accepted too, like in query strings
+        if (*pp.p == '[') {
+            pp.p++;
+            err = jcsn_path_bracket(&pp, st);
+        } else {
+            err = jcsn_path_dotted(&pp, st);
+        }
+        if (err)
+            goto err;
+        jp->len += 1;
+    }
+    return jp;
+
+err:
+    JCSN_LOG_ERR("Invalid JSONPath at offset %zu\n", (size_t)(pp.p - path));
+    xfree(jp);
+    return NULL;
+}
+
+
+void jcsn_path_iter(Jcsn_PathIter *it, const Jcsn_Path *path, const Jcsn_JValue *root) {
+    it->path = path;
+    it->depth = 0;
+    if (path && root)
+        jcsn_path_push(it, root, 0);
+}
+
+
+// Depth first walk: a frame is a value reached after `step` steps. It
+// runs it's selector on each candidate child, then (for `..`) walks
+// into each json object/array child with the same step.
+Jcsn_JValue *jcsn_path_next(Jcsn_PathIter *it) {
+    const Jcsn_Path_Step *st;
+    const Jcsn_JValue *val, *child;
+    size_t count, pos;
+    long first = 0;
+
+    while (it->depth) {
+        val = it->frames[it->depth - 1].val;
+        pos = it->frames[it->depth - 1].pos;
+        if (it->frames[it->depth - 1].step == it->path->len) {
+            it->depth -= 1;
+            return (Jcsn_JValue*)val;
+        }
+
+        st = &it->path->steps[it->frames[it->depth - 1].step];
+        count = jcsn_path_candidates(st, val, &first);
+        it->frames[it->depth - 1].pos += 1;
+
+        if (pos < count) {
+            child = jcsn_path_candidate(st, val, first, pos);
+            if (child)
+                jcsn_path_push(it, child, it->frames[it->depth - 1].step + 1);
+        } else if (st->descent && pos - count < jcsn_path_len(val)) {
+            child = jcsn_path_child(val, pos - count);
+            if (child && (child->type == J_OBJECT || child->type == J_ARRAY))
+                jcsn_path_push(it, child, it->frames[it->depth - 1].step);
+        } else {
+            it->depth -= 1;
+        }
+    }
+    return NULL;
+}
+
+
+void jcsn_path_free(Jcsn_Path *path) {
+    xfree(path);
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,112 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * JSONPath Module
+ * Get every json value that matches a JSONPath expression
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_PATH_H
+#define __JACSON_PATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <jacson/jacson.h>
+
+
+
+/**
+ * Types
+ */
+
+// Selector of a step of a JSONPath
+enum Jcsn_Path_Op {
+    P_NAME,     // .name or ['name']
+    P_INDEX,    // [N]
+    P_WILDCARD, // .* or [*]
+    P_SLICE,    // [start:end:step]
+    P_FILTER,   // [?(@.a.b <op> literal)]
+};
+
+
+// Comparison of a filter
+enum Jcsn_Path_Cmp {
+    C_EXISTS, // [?(@.a)]
+    C_EQ,
+    C_NE,
+    C_LT,
+    C_LE,
+    C_GT,
+    C_GE,
+};
+
+
+// A member name or an array index (`name` is NULL)
+typedef struct Jcsn_Path_Key {
+    const char *name;
+    size_t len;
+    uint32_t hash;
+    long idx;
+} Jcsn_Path_Key;
+
+
+// A step of a JSONPath picks children of each value matched by steps
+// before it. With `descent` (`..`), it picks them from that value and
+// all of it's descendants.
+typedef struct Jcsn_Path_Step {
+    enum Jcsn_Path_Op op;
+    bool descent;
+
+    union {
+        // P_NAME, P_INDEX
+        Jcsn_Path_Key key;
+
+        // P_SLICE
+        struct {
+            long start;
+            long end;
+            long step;
+            bool has_start;
+            bool has_end;
+        } slice;
+
+        // P_FILTER: a child matches if value at relative path `keys`
+        // compares to `literal`
+        struct {
+            const Jcsn_Path_Key *keys;
+            size_t len;
+            enum Jcsn_Path_Cmp cmp;
+            Jcsn_JValue literal;
+        } filter;
+    } u;
+} Jcsn_Path_Step;
+
+
+// A compiled JSONPath is one block of memory: steps, keys of filters,
+// then names (null terminated). It's never modified after compile.
+struct Jcsn_Path {
+    size_t len;
+    Jcsn_Path_Step *steps;
+};
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_PATH_H
@@ -31,12 +31,28 @@ extern "C" {
 #endif // __JCSN_TRACE__
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 
 // Jacson
 #include "log.h"
 #include "str.h"
 #include "mem.h"
+#include "lexer.h"
+#include "jvalue.h"
+#include "aggregate.h"
 #include "query.h"
+#include <jacson/jacson.h>
+
+
+/**
+ * Macros and constants
+ */
+
+// First window of raw json data walked by an on-demand query (bytes)
+#ifndef JCSN_QUERY_WINDOW
+    #define JCSN_QUERY_WINDOW (64 * 1024)
+#endif
+
 
 
 /**
@@ -54,106 +70,124 @@ enum Jcsn_QType {
 // a query token
 typedef struct jcsn_qtoken {
     union {
-        char *str;
+        Jcsn_JString str;
         long idx;
     } data;
     enum Jcsn_QType type;
+
+    // Hash of name (See `jcsn_string_hash`)
+    uint32_t hash;
 } Jcsn_QToken;
 
 
-// an array of tokens
-typedef struct jcsn_qtlist {
-    Jcsn_QToken *tokens;
+// A compiled query is one block of memory: tokens, then every part of
+// query string they were made from (null terminated). It's never
+// modified after `jcsn_query_compile`.
+struct Jcsn_Query {
     size_t len;
-} Jcsn_QTList;
 
+    // Aggregate function that query string ends in (not a token)
+    enum Jcsn_Agg_Fn fn;
+    Jcsn_QToken tokens[];
+};
 
-/**
- * Module Private API
- */
 
-// Initialize token list
-static void jcsn_qtlist_init(Jcsn_QTList *tlist,
-                             const char *query,
-                             const size_t q_len)
-{
-    size_t i;
-    for (i = 0; i < q_len; i++)
-        if (query[i] == '.')
-            tlist->len += 1;
-    // Include last token
-    tlist->len += 1;
-
-    tlist->tokens = malloc(sizeof(Jcsn_QToken) * tlist->len);
-    if (!tlist->tokens) {
-        JCSN_LOG_ERR("Failed to allocate memory for query token list\n", NULL);
-        tlist->len = 0;
-    }
-}
+// A node of a query set trie. A node is reached from it's parent by
+// token `tk` and children of a node are next to each other: names
+// first, then indices in ascending order.
+typedef struct Jcsn_QNode {
+    const Jcsn_QToken *tk;
+    uint32_t first;
+    uint32_t names;
+    uint32_t indices;
 
+    // Nodes that a query ends at in this subtree (this node included)
+    uint32_t terms;
 
-static Jcsn_QTList jcsn_tokenize_query(const char *query) {
-    Jcsn_QTList tlist = {
-        .tokens = NULL,
-        .len = 0,
-    };
+    // Index of first query that ends at this node (-1 if none)
+    int32_t result;
+} Jcsn_QNode;
 
-    size_t q_len = strlen(query);
-    if (q_len == 0)
-        goto ret;
 
-    jcsn_qtlist_init(&tlist, query, q_len);
-    if (!tlist.tokens)
-        goto ret;
+// Queries of a set are merged into a trie, so a prefix shared by many
+// queries is only resolved once. Root of trie is `nodes[0]`.
+struct Jcsn_QuerySet {
+    // Number of queries
+    size_t n;
 
-    long idx, i = 0;
-    char *tk_str = NULL, *q = strdup(query);
-    Jcsn_QToken token = { 0 };
+    // Compiled queries (NULL for an empty query). Tokens of trie point
+    // into them.
+    Jcsn_Query **queries;
 
-    tk_str = strtok(q, ".");
-    while (tk_str) {
-        if (*tk_str == '[') {
-            idx = jcsn_string_to_long(tk_str);
-            token = (Jcsn_QToken) {
-                .type = Q_IDX,
-                .data.idx = idx,
-            };
-        } else {
-            token = (Jcsn_QToken) {
-                .type = Q_NAME,
-                .data.str = strdup(tk_str),
-            };
-        }
+    // Index of first query equal to each query (-1 for an empty query)
+    int32_t *same;
 
-        tk_str = strtok(NULL, ".");
-        tlist.tokens[i] = token;
-        i += 1;
-    }
+    Jcsn_QNode *nodes;
+    size_t len;
+};
 
-    free(q);
-ret:
-    return tlist;
+
+// A node of a query set trie while it's being built. Children are a
+// linked list (0 -> none, root is never a child).
+typedef struct Jcsn_QTrie {
+    const Jcsn_QToken *tk;
+    uint32_t kid;
+    uint32_t next;
+    int32_t result;
+} Jcsn_QTrie;
+
+
+// State of walking raw json data along a query set
+typedef struct Jcsn_SetWalk {
+    Jcsn_Lexer lexer;
+    char *jdata;
+    size_t len;
+    bool whole;
+    int flags;
+
+    const Jcsn_QuerySet *qs;
+    Jcsn_JValue **results;
+    Jcsn_AST **asts;
+
+    // Nodes already walked (first of duplicate names wins)
+    bool *seen;
+
+    // Nodes that a query ends at and are not walked yet
+    size_t left;
+} Jcsn_SetWalk;
+
+
+/**
+ * Module Private API
+ */
+
+// Find next part of query string between `.`s. Empty parts are skipped.
+// Returns NULL when there is no part left.
+static const char *jcsn_query_part(const char *q, size_t *len) {
+    while (*q == '.')
+        q++;
+    if (*q == '\0')
+        return NULL;
+
+    *len = strcspn(q, ".");
+    return q;
 }
 
 
-static Jcsn_JValue *jcsn_collection_find(Jcsn_JValue *coll, Jcsn_QToken *tk) {
-    size_t i = 0;
+// Get child of json object/array `coll` that `tk` refers to
+static Jcsn_JValue *jcsn_collection_find(const Jcsn_JValue *coll, const Jcsn_QToken *tk) {
     switch (coll->type) {
         case J_ARRAY: {
-            if (tk->type != Q_IDX)
+            if (tk->type != Q_IDX || tk->data.idx < 0)
                 goto ret;
-            return &coll->data.array.vals[tk->data.idx];
+            return jcsn_jarr_get(coll, (size_t)tk->data.idx);
         }
         break;
 
         case J_OBJECT: {
             if (tk->type != Q_NAME)
                 goto ret;
-            Jcsn_JObject obj = coll->data.object;
-            for (i = 0; i < obj.len; i++) {
-                if (strcmp(tk->data.str, obj.names[i]) == 0)
-                    return &obj.values[i];
-            }
+            return jcsn_jobj_find(coll, tk->data.str.data, tk->data.str.len, tk->hash);
         }
         break;
 
@@ -166,14 +200,452 @@ ret:
 }
 
 
-static void jcsn_qtlist_free(Jcsn_QTList *qtl) {
-    if (qtl) {
-        for (size_t i = 0; i < qtl->len; i++) {
-            Jcsn_QToken *t = &qtl->tokens[i];
-            if (t->type == Q_NAME)
-                xfree(t->data.str);
+// Lexer is right after a '{'. Move it right before value of member named
+// `name` (right after ':'), skipping every other member.
+// 0 -> found
+// 1 -> not found or invalid json data
+static int jcsn_seek_member(Jcsn_Lexer *lexer, const Jcsn_JString *name) {
+    Jcsn_Token tk;
+    size_t start;
+    bool found;
+
+    while (1) {
+        // '}' means there is no such member
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != TK_STRING)
+            return 1;
+        // unescaped names are only valid until next token
+        found = tk.value.string.len == name->len
+            && memcmp(tk.value.string.data, name->data, name->len) == 0;
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != ':')
+            return 1;
+        if (found)
+            return 0;
+
+        if (jcsn_lexer_skip(lexer, &start))
+            return 1;
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != ',')
+            return 1;
+    }
+}
+
+
+// Lexer is right after a '['. Move it right before element at `idx`,
+// skipping every element before it.
+// 0 -> ok (element may still not exist)
+// 1 -> not found or invalid json data
+static int jcsn_seek_element(Jcsn_Lexer *lexer, long idx) {
+    Jcsn_Token tk;
+    size_t start;
+
+    for (long i = 0; i < idx; i++) {
+        if (jcsn_lexer_skip(lexer, &start))
+            return 1;
+        // ']' means there are not enough elements
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != ',')
+            return 1;
+    }
+    return 0;
+}
+
+
+// Lexer is right before a json value. Parse it into a new AST and move
+// lexer right after it. A json object/array ends at it's closing
+// bracket and a scalar at end of it's token. If `whole` is false, json
+// data goes on after `len` bytes.
+// 0 -> ok
+// 1 -> there is no complete json value or out of memory
+static int jcsn_parse_value(Jcsn_Lexer *lexer,
+                            size_t len,
+                            bool whole,
+                            int flags,
+                            Jcsn_AST **result)
+{
+    Jcsn_Lexer sub;
+    Jcsn_Token tk;
+    size_t start, end;
+    char *jdata = lexer->first;
+
+    if (jcsn_lexer_skip(lexer, &start))
+        return 1;
+    if (jdata[start] == '{' || jdata[start] == '[') {
+        end = (size_t)(lexer->base - lexer->first);
+    } else {
+        jcsn_lexer_init(&sub, jdata + start, len - start, flags);
+        if (jcsn_lexer_next(&sub, &tk)) {
+            jcsn_lexer_free(&sub);
+            return 1;
         }
-        xfree(qtl->tokens);
+        end = start + (size_t)(sub.base - sub.first);
+        jcsn_lexer_free(&sub);
+        // a number may go on after `len`
+        if (end == len && !whole)
+            return 1;
+    }
+
+    *result = jcsn_parser_parse_span(jdata + start, end - start, flags);
+    return (*result == NULL);
+}
+
+
+// Walk of `len` bytes of raw json data failed. If `whole` is false, json
+// data goes on after those bytes, and a failure after lexer ran out of
+// them may be because of a value cut at the end.
+// 1 -> failure is final
+// 2 -> json data must be walked again in a bigger window
+static int jcsn_window_failure(Jcsn_Lexer *lexer, bool whole) {
+    return (!whole && jcsn_lexer_peek(lexer) == '\0') ? 2 : 1;
+}
+
+
+// Walk `len` bytes of raw json data along query path. If `whole` is
+// false, json data goes on after those bytes.
+// 0 -> value found and parsed into `result`
+// 1 -> not found, invalid json data or out of memory
+// 2 -> ran out of bytes before value was found (See `jcsn_window_failure`)
+static int jcsn_query_span(char *jdata,
+                           size_t len,
+                           bool whole,
+                           int flags,
+                           const Jcsn_Query *q,
+                           Jcsn_AST **result)
+{
+    Jcsn_Lexer lexer;
+    Jcsn_Token tk;
+    const Jcsn_QToken *t;
+    int ret = 1;
+
+    jcsn_lexer_init(&lexer, jdata, len, flags);
+    for (size_t i = 0; i < q->len; i++) {
+        t = &q->tokens[i];
+        if (jcsn_lexer_next(&lexer, &tk))
+            goto ret;
+
+        if (t->type == Q_NAME) {
+            if (tk.type != '{' || jcsn_seek_member(&lexer, &t->data.str))
+                goto ret;
+        } else {
+            if (tk.type != '[' || t->data.idx < 0 || jcsn_seek_element(&lexer, t->data.idx))
+                goto ret;
+        }
+    }
+
+    ret = jcsn_parse_value(&lexer, len, whole, flags, result);
+
+ret:
+    if (ret)
+        ret = jcsn_window_failure(&lexer, whole);
+    jcsn_lexer_free(&lexer);
+    return ret;
+}
+
+
+
+// Tokens of a query set trie are merged when they are equal
+static bool jcsn_qtoken_equal(const Jcsn_QToken *a, const Jcsn_QToken *b) {
+    if (a->type != b->type)
+        return false;
+    if (a->type == Q_IDX)
+        return a->data.idx == b->data.idx;
+    return a->data.str.len == b->data.str.len
+        && memcmp(a->data.str.data, b->data.str.data, a->data.str.len) == 0;
+}
+
+
+// Order of children of a trie node: names, then indices in ascending
+// order
+static bool jcsn_qtoken_before(const Jcsn_QToken *a, const Jcsn_QToken *b) {
+    if (a->type != b->type)
+        return a->type == Q_NAME;
+    return a->type == Q_IDX && a->data.idx < b->data.idx;
+}
+
+
+// Merge compiled queries of a set into a trie. Returns number of trie
+// nodes or 0 if out of memory.
+static size_t jcsn_qtrie_build(Jcsn_QuerySet *qs, Jcsn_QTrie **trie) {
+    size_t len = 1, cap = 16;
+    const Jcsn_Query *q;
+    uint32_t cur, k;
+    void *tmp;
+
+    Jcsn_QTrie *t = malloc(sizeof(*t) * cap);
+    if (!t)
+        return 0;
+    t[0] = (Jcsn_QTrie) { .tk = NULL, .kid = 0, .next = 0, .result = -1 };
+
+    for (size_t i = 0; i < qs->n; i++) {
+        q = qs->queries[i];
+        if (!q) {
+            qs->same[i] = -1;
+            continue;
+        }
+
+        cur = 0;
+        for (size_t d = 0; d < q->len; d++) {
+            for (k = t[cur].kid; k && !jcsn_qtoken_equal(t[k].tk, &q->tokens[d]); k = t[k].next)
+                ;
+            if (!k) {
+                if (len == cap) {
+                    cap <<= 1;
+                    tmp = realloc(t, sizeof(*t) * cap);
+                    if (!tmp) {
+                        xfree(t);
+                        return 0;
+                    }
+                    t = tmp;
+                }
+                k = (uint32_t)len++;
+                t[k] = (Jcsn_QTrie) {
+                    .tk = &q->tokens[d],
+                    .kid = 0,
+                    .next = t[cur].kid,
+                    .result = -1,
+                };
+                t[cur].kid = k;
+            }
+            cur = k;
+        }
+
+        if (t[cur].result < 0)
+            t[cur].result = (int32_t)i;
+        qs->same[i] = t[cur].result;
+    }
+
+    *trie = t;
+    return len;
+}
+
+
+// Lay trie out breadth first, so children of a node are next to each
+// other and come after it.
+// 0 -> ok
+// 1 -> out of memory
+static int jcsn_qtrie_flatten(Jcsn_QuerySet *qs, const Jcsn_QTrie *t, size_t len) {
+    uint32_t *order = malloc(sizeof(*order) * len);
+    size_t tail = 1, j;
+    Jcsn_QNode *node;
+
+    qs->nodes = malloc(sizeof(*qs->nodes) * len);
+    if (!order || !qs->nodes) {
+        xfree(order);
+        return 1;
+    }
+    qs->len = len;
+
+    order[0] = 0;
+    for (size_t pos = 0; pos < len; pos++) {
+        const Jcsn_QTrie *tn = &t[order[pos]];
+        node = &qs->nodes[pos];
+        *node = (Jcsn_QNode) {
+            .tk = tn->tk,
+            .first = (uint32_t)tail,
+            .names = 0,
+            .indices = 0,
+            .terms = 0,
+            .result = tn->result,
+        };
+
+        // insertion sort, a node has a few children
+        for (uint32_t k = tn->kid; k; k = t[k].next) {
+            for (j = tail; j > node->first && jcsn_qtoken_before(t[k].tk, t[order[j - 1]].tk); j--)
+                order[j] = order[j - 1];
+            order[j] = k;
+            tail += 1;
+
+            if (t[k].tk->type == Q_NAME)
+                node->names += 1;
+            else
+                node->indices += 1;
+        }
+    }
+
+    for (size_t pos = len; pos-- > 0;) {
+        node = &qs->nodes[pos];
+        node->terms = (node->result >= 0);
+        for (uint32_t k = 0; k < node->names + node->indices; k++)
+            node->terms += qs->nodes[node->first + k].terms;
+    }
+
+    xfree(order);
+    return 0;
+}
+
+
+// Json value `val` is reached at trie node `node`. Recursion is only as
+// deep as the longest query of set.
+static void jcsn_set_walk(const Jcsn_QuerySet *qs,
+                          const Jcsn_QNode *node,
+                          const Jcsn_JValue *val,
+                          Jcsn_JValue **results)
+{
+    const Jcsn_QNode *kid;
+    Jcsn_JValue *v;
+
+    if (node->result >= 0)
+        results[node->result] = (Jcsn_JValue*)val;
+
+    for (uint32_t i = 0; i < node->names + node->indices; i++) {
+        kid = &qs->nodes[node->first + i];
+        v = jcsn_collection_find(val, kid->tk);
+        if (v)
+            jcsn_set_walk(qs, kid, v, results);
+    }
+}
+
+
+// Copy values of queries to queries equal to them and count values
+static size_t jcsn_set_results(const Jcsn_QuerySet *qs, Jcsn_JValue **results) {
+    size_t found = 0;
+    for (size_t i = 0; i < qs->n; i++) {
+        results[i] = (qs->same[i] >= 0) ? results[qs->same[i]] : NULL;
+        found += (results[i] != NULL);
+    }
+    return found;
+}
+
+
+static int jcsn_set_walk_raw(Jcsn_SetWalk *w, const Jcsn_QNode *node);
+
+
+// Nothing more is walked in json value at trie node `node`. Queries under
+// kids of it that were not walked have no value.
+// 0 -> walk goes on
+// 2 -> every query of set has it's value or has none, walk is over
+static int jcsn_set_walk_done(Jcsn_SetWalk *w, const Jcsn_QNode *node) {
+    for (uint32_t i = node->first; i < node->first + node->names + node->indices; i++) {
+        if (!w->seen[i])
+            w->left -= w->qs->nodes[i].terms;
+    }
+    return (w->left) ? 0 : 2;
+}
+
+
+// Lexer is right after '{' of json object at trie node `node`
+static int jcsn_set_walk_object(Jcsn_SetWalk *w, const Jcsn_QNode *node) {
+    Jcsn_Lexer *lexer = &w->lexer;
+    const Jcsn_QNode *kid;
+    Jcsn_Token tk;
+    size_t start, left = node->names;
+    uint32_t i;
+    int ret;
+
+    if (!left)
+        return (jcsn_set_walk_done(w, node)) ? 2 : jcsn_lexer_leave(lexer);
+    if (jcsn_lexer_peek(lexer) == '}')
+        return (jcsn_lexer_next(lexer, &tk)) ? 1 : jcsn_set_walk_done(w, node);
+
+    while (1) {
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != TK_STRING)
+            return 1;
+        // unescaped names are only valid until next token
+        for (i = 0, kid = NULL; i < node->names && !kid; i++) {
+            kid = &w->qs->nodes[node->first + i];
+            if (w->seen[node->first + i]
+                || kid->tk->data.str.len != tk.value.string.len
+                || memcmp(kid->tk->data.str.data, tk.value.string.data, tk.value.string.len) != 0)
+                kid = NULL;
+        }
+        if (jcsn_lexer_next(lexer, &tk) || tk.type != ':')
+            return 1;
+
+        if (kid) {
+            w->seen[kid - w->qs->nodes] = true;
+            left -= 1;
+            if ((ret = jcsn_set_walk_raw(w, kid)))
+                return ret;
+        } else if (jcsn_lexer_skip(lexer, &start)) {
+            return 1;
+        }
+
+        // every member of json object that is needed is walked
+        if (!left)
+            return (jcsn_set_walk_done(w, node)) ? 2 : jcsn_lexer_leave(lexer);
+        if (jcsn_lexer_next(lexer, &tk))
+            return 1;
+        if (tk.type == '}')
+            return jcsn_set_walk_done(w, node);
+        if (tk.type != ',')
+            return 1;
+    }
+}
+
+
+// Lexer is right after '[' of json array at trie node `node`
+static int jcsn_set_walk_array(Jcsn_SetWalk *w, const Jcsn_QNode *node) {
+    Jcsn_Lexer *lexer = &w->lexer;
+    uint32_t k = node->first + node->names, end = k + node->indices;
+    Jcsn_Token tk;
+    size_t start;
+    int ret;
+
+    // negative indices are never found
+    while (k < end && w->qs->nodes[k].tk->data.idx < 0)
+        k++;
+    if (k == end)
+        return (jcsn_set_walk_done(w, node)) ? 2 : jcsn_lexer_leave(lexer);
+    if (jcsn_lexer_peek(lexer) == ']')
+        return (jcsn_lexer_next(lexer, &tk)) ? 1 : jcsn_set_walk_done(w, node);
+
+    for (long i = 0; ; i++) {
+        if (w->qs->nodes[k].tk->data.idx == i) {
+            w->seen[k] = true;
+            if ((ret = jcsn_set_walk_raw(w, &w->qs->nodes[k])))
+                return ret;
+            if (++k == end)
+                return (jcsn_set_walk_done(w, node)) ? 2 : jcsn_lexer_leave(lexer);
+        } else if (jcsn_lexer_skip(lexer, &start)) {
+            return 1;
+        }
+
+        if (jcsn_lexer_next(lexer, &tk))
+            return 1;
+        if (tk.type == ']')
+            return jcsn_set_walk_done(w, node);
+        if (tk.type != ',')
+            return 1;
+    }
+}
+
+
+// Lexer is right before json value at trie node `node`. Walk it and
+// move lexer right after it. Recursion is only as deep as the longest
+// query of set.
+// 0 -> ok
+// 1 -> invalid or incomplete json data or out of memory
+// 2 -> every query of set has it's value or has none, walk is over
+static int jcsn_set_walk_raw(Jcsn_SetWalk *w, const Jcsn_QNode *node) {
+    Jcsn_Token tk;
+    Jcsn_AST *ast;
+
+    // value of a query is parsed and queries that go deeper than it are
+    // run on it's AST
+    if (node->result >= 0) {
+        if (jcsn_parse_value(&w->lexer, w->len, w->whole, w->flags, &ast))
+            return 1;
+        w->asts[node->result] = ast;
+        jcsn_set_walk(w->qs, node, jcsn_ast_get_root(ast), w->results);
+        w->left -= node->terms;
+        return (w->left) ? 0 : 2;
+    }
+
+    if (jcsn_lexer_next(&w->lexer, &tk))
+        return 1;
+    switch (tk.type) {
+        case TK_OBJ_BEG:
+            return jcsn_set_walk_object(w, node);
+
+        case TK_ARR_BEG:
+            return jcsn_set_walk_array(w, node);
+
+        case TK_STRING:
+        case TK_INTEGER:
+        case TK_REAL:
+        case TK_BOOL:
+        case TK_NULL:
+            return jcsn_set_walk_done(w, node);
+
+        default:
+            return 1;
     }
 }
 
@@ -183,39 +655,257 @@ static void jcsn_qtlist_free(Jcsn_QTList *qtl) {
  * Module Public API
  */
 
-// Get a value from AST
-Jcsn_JValue *jcsn_query_value(Jcsn_JValue *root, const char *query) {
-    Jcsn_QToken t = { 0 };
-    Jcsn_JValue *result = NULL, *scope = root;
+Jcsn_Query *jcsn_query_compile(const char *query) {
+    Jcsn_Query *q = NULL;
+    Jcsn_QToken *tk;
+    const char *part, *last = NULL;
+    size_t n = 0, bytes = 0, len, last_len = 0;
+    enum Jcsn_Agg_Fn fn = AGG_NONE;
+    char *s;
+
+    for (part = jcsn_query_part(query, &len); part; part = jcsn_query_part(part + len, &len)) {
+        n += 1;
+        bytes += len + 1;
+        last = part;
+        last_len = len;
+    }
 
-    Jcsn_QTList tlist = jcsn_tokenize_query(query);
-    if (tlist.len == 0) {
+    // only last part may be a function call
+    if (last_len > 2 && memcmp(last + last_len - 2, "()", 2) == 0) {
+        fn = jcsn_agg_function(last, last_len - 2);
+        if (fn == AGG_NONE) {
+            JCSN_LOG_ERR("Unknown query function\n", NULL);
+            goto ret;
+        }
+        n -= 1;
+    }
+    if (n == 0 && fn == AGG_NONE) {
         JCSN_LOG_ERR("Token list is empty\n", NULL);
-        return NULL;
+        goto ret;
     }
 
-    for (size_t i = 0; i < tlist.len; i++) {
-        t = tlist.tokens[i];
-        if (scope->type == J_ARRAY && t.type != Q_IDX) {
-            JCSN_LOG_ERR("Could not query a json array with a Q_NAME token\n", NULL);
-            JCSN_LOG_ERR("Use \'[N]\' syntax to get an index from json array\n", NULL);
-            jcsn_qtlist_free(&tlist);
-            return NULL;
+    q = malloc(sizeof(*q) + sizeof(Jcsn_QToken) * n + bytes);
+    if (!q) {
+        JCSN_LOG_ERR("Failed to allocate memory for query token list\n", NULL);
+        goto ret;
+    }
+    q->len = n;
+    q->fn = fn;
+
+    tk = q->tokens;
+    s = (char*)(q->tokens + n);
+    part = jcsn_query_part(query, &len);
+    for (size_t i = 0; i < n; i++, part = jcsn_query_part(part + len, &len)) {
+        memcpy(s, part, len);
+        s[len] = '\0';
+        if (*s == '[') {
+            *tk = (Jcsn_QToken) {
+                .type = Q_IDX,
+                .data.idx = jcsn_string_to_long(s),
+            };
+        } else {
+            *tk = (Jcsn_QToken) {
+                .type = Q_NAME,
+                .data.str = {
+                    .data = s,
+                    .len = len,
+                },
+                .hash = jcsn_string_hash(s, len),
+            };
         }
+        tk += 1;
+        s += len + 1;
+    }
+
+ret:
+    return q;
+}
+
 
-        result = jcsn_collection_find(scope, &t);
-        if (!result)
+Jcsn_JValue *jcsn_query_exec(const Jcsn_Query *q, const Jcsn_JValue *root) {
+    if (!q || q->fn != AGG_NONE)
+        return NULL;
+    return jcsn_query_target(q, root);
+}
+
+
+Jcsn_JValue *jcsn_query_target(const Jcsn_Query *q, const Jcsn_JValue *root) {
+    const Jcsn_JValue *val = root;
+    if (!q || !val)
+        return NULL;
+
+    for (size_t i = 0; i < q->len && val; i++)
+        val = jcsn_collection_find(val, &q->tokens[i]);
+    return (Jcsn_JValue*)val;
+}
+
+
+enum Jcsn_Agg_Fn jcsn_query_function(const Jcsn_Query *q) {
+    return (q) ? q->fn : AGG_NONE;
+}
+
+
+void jcsn_query_free(Jcsn_Query *q) {
+    xfree(q);
+}
+
+
+// On-demand query. Raw json data is walked along query path: only names
+// of json object members on the path are tokenized and everything else
+// is skipped by matching brackets. Only value of query is parsed.
+// Length of json data is not known in advance. It's walked in a window
+// that grows 4 times each time walk runs out of it before value, so
+// bytes after value are not even read. A query that fails for any other
+// reason (e.g. a missing member) fails at once.
+Jcsn_AST *jcsn_query_raw(char *jdata, int flags, const Jcsn_Query *q) {
+    Jcsn_AST *result = NULL;
+    size_t window = JCSN_QUERY_WINDOW, len;
+    bool whole;
+
+    if (!q)
+        return NULL;
+
+    // raw json data is walked again by next queries, keep it intact
+    flags &= ~JCSN_PARSE_INSITU;
+
+    do {
+        len = strnlen(jdata, window);
+        whole = (len < window);
+        if (jcsn_query_span(jdata, len, whole, flags, q, &result) != 2)
+            break;
+        window <<= 2;
+    } while (!whole);
+
+    return result;
+}
+
+
+
+size_t jcsn_query_set_raw(char *jdata,
+                          int flags,
+                          const Jcsn_QuerySet *qs,
+                          Jcsn_JValue **results,
+                          Jcsn_AST **asts)
+{
+    size_t window = JCSN_QUERY_WINDOW;
+    bool restart;
+    int ret;
+    Jcsn_SetWalk w = {
+        .jdata = jdata,
+        // raw json data is walked again by next queries, keep it intact
+        .flags = flags & ~JCSN_PARSE_INSITU,
+        .qs = qs,
+        .results = results,
+        .asts = asts,
+    };
+
+    for (size_t i = 0; i < qs->n; i++) {
+        results[i] = NULL;
+        asts[i] = NULL;
+    }
+    if (!qs->nodes[0].terms)
+        return 0;
+
+    w.seen = calloc(qs->len, sizeof(*w.seen));
+    if (!w.seen)
+        return 0;
+
+    // Same windows as `jcsn_query_raw`. Walk starts over in a bigger
+    // window only if it runs out of json data in window.
+    while (1) {
+        w.len = strnlen(jdata, window);
+        w.whole = (w.len < window);
+        w.left = qs->nodes[0].terms;
+
+        jcsn_lexer_init(&w.lexer, jdata, w.len, w.flags);
+        // 2 of walk means it's over, not that it ran out of window
+        ret = jcsn_set_walk_raw(&w, &qs->nodes[0]);
+        restart = (ret == 1 && jcsn_window_failure(&w.lexer, w.whole) == 2);
+        jcsn_lexer_free(&w.lexer);
+        if (!restart)
             break;
 
-        if (result->type == J_ARRAY || result->type == J_OBJECT)
-            scope = result;
+        for (size_t i = 0; i < qs->n; i++) {
+            jcsn_ast_free(asts[i]);
+            asts[i] = NULL;
+            results[i] = NULL;
+        }
+        memset(w.seen, 0, sizeof(*w.seen) * qs->len);
+        window <<= 2;
     }
 
-    jcsn_qtlist_free(&tlist);
-    return result;
+    xfree(w.seen);
+    return jcsn_set_results(qs, results);
+}
+
+
+Jcsn_QuerySet *jcsn_query_set_compile(const char *const *queries, size_t n) {
+    Jcsn_QTrie *trie = NULL;
+    size_t len;
+
+    Jcsn_QuerySet *qs = calloc(1, sizeof(*qs));
+    if (!qs)
+        return NULL;
+    if (n > INT32_MAX)
+        goto err;
+
+    qs->n = n;
+    qs->queries = calloc((n) ? n : 1, sizeof(*qs->queries));
+    qs->same = malloc(sizeof(*qs->same) * ((n) ? n : 1));
+    if (!qs->queries || !qs->same)
+        goto err;
+
+    for (size_t i = 0; i < n; i++) {
+        qs->queries[i] = jcsn_query_compile(queries[i]);
+        // NULL is only ok for an empty query
+        if (!qs->queries[i] && jcsn_query_part(queries[i], &len))
+            goto err;
+        if (qs->queries[i] && qs->queries[i]->fn != AGG_NONE) {
+            JCSN_LOG_ERR("Query functions are not supported in query sets\n", NULL);
+            goto err;
+        }
+    }
+
+    len = jcsn_qtrie_build(qs, &trie);
+    if (!len || jcsn_qtrie_flatten(qs, trie, len))
+        goto err;
+
+    xfree(trie);
+    return qs;
+
+err:
+    JCSN_LOG_ERR("Failed to compile query set\n", NULL);
+    xfree(trie);
+    jcsn_query_set_free(qs);
+    return NULL;
 }
 
 
+size_t jcsn_query_set_exec(const Jcsn_QuerySet *qs, const Jcsn_JValue *root, Jcsn_JValue **results) {
+    for (size_t i = 0; i < qs->n; i++)
+        results[i] = NULL;
+    if (root)
+        jcsn_set_walk(qs, &qs->nodes[0], root, results);
+    return jcsn_set_results(qs, results);
+}
+
+
+size_t jcsn_query_set_len(const Jcsn_QuerySet *qs) {
+    return qs->n;
+}
+
+
+void jcsn_query_set_free(Jcsn_QuerySet *qs) {
+    if (!qs)
+        return;
+    for (size_t i = 0; qs->queries && i < qs->n; i++)
+        jcsn_query_free(qs->queries[i]);
+    xfree(qs->queries);
+    xfree(qs->same);
+    xfree(qs->nodes);
+    xfree(qs);
+}
+
 
 #ifdef __cplusplus
 }
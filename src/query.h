@@ -30,6 +30,9 @@ extern "C" {
 
 // Jacson
 #include <jacson/jtypes.h>
+#include <jacson/jacson.h>
+#include "parser.h"
+#include "aggregate.h"
 
 
 
@@ -37,8 +40,31 @@ extern "C" {
  * Module Public API
  */
 
-// Get a value from AST
-Jcsn_JValue *jcsn_query_value(Jcsn_JValue *root, const char *query);
+// Get value at path of compiled query `q`, starting from `root`. Unlike
+// `jcsn_query_exec`, aggregate function of query is ignored.
+Jcsn_JValue *jcsn_query_target(const Jcsn_Query *q, const Jcsn_JValue *root);
+
+// Get aggregate function that query string of `q` ends in
+enum Jcsn_Agg_Fn jcsn_query_function(const Jcsn_Query *q);
+
+// Get value of compiled query `q` from null terminated raw json data
+// without parsing all of it. Value is parsed into a new AST (NULL if
+// it's not found).
+Jcsn_AST *jcsn_query_raw(char *jdata, int flags, const Jcsn_Query *q);
+
+// Get values of every query of set `qs` from null terminated raw json
+// data in one walk. A value is parsed into a new AST that is stored in
+// `asts` at index of it's query (values of queries that go deeper into
+// another value share it's AST). `results` and `asts` have room for
+// `jcsn_query_set_len(qs)` pointers. Returns number of values found.
+size_t jcsn_query_set_raw(char *jdata,
+                          int flags,
+                          const Jcsn_QuerySet *qs,
+                          Jcsn_JValue **results,
+                          Jcsn_AST **asts);
+
+// Get number of queries of a query set
+size_t jcsn_query_set_len(const Jcsn_QuerySet *qs);
 
 
 
@@ -0,0 +1,557 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Structural Scanner Module
+ * Find structural characters in raw json data, a block at a time
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#include <string.h>
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSSE3__)
+    #include <tmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// Jacson
+#include "scan.h"
+
+
+
+/**
+ * Types
+ */
+
+// Bitmaps of one classified block.
+// Bit N of each field describes N'th byte of the block.
+typedef struct Jcsn_Block {
+    uint64_t op;    // { } [ ] : ,
+    uint64_t ws;    // space, \t, \n, \r
+    uint64_t quote; // "
+    uint64_t bs;    // backslash
+} Jcsn_Block;
+
+
+
+/**
+ * Module Private API
+ */
+
+#if defined(_MSC_VER)
+static __inline int jcsn_ctz64(uint64_t x) {
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (int)i;
+}
+#else
+    #define jcsn_ctz64(x) __builtin_ctzll((x))
+#endif
+
+
+#if defined(__AVX2__)
+
+static void jcsn_classify(const char *p, Jcsn_Block *b) {
+    const __m256i obrace = _mm256_set1_epi8('{'), cbrace = _mm256_set1_epi8('}');
+    const __m256i colon  = _mm256_set1_epi8(':'), comma  = _mm256_set1_epi8(',');
+    const __m256i space  = _mm256_set1_epi8(' '), tab    = _mm256_set1_epi8('\t');
+    const __m256i lf     = _mm256_set1_epi8('\n'), cr    = _mm256_set1_epi8('\r');
+    const __m256i quote  = _mm256_set1_epi8('\"'), bs    = _mm256_set1_epi8('\\');
+    const __m256i lower  = _mm256_set1_epi8(0x20);
+    __m256i c, l, op, ws;
+    int i;
+
+    *b = (Jcsn_Block) { 0 };
+    for (i = 0; i < 2; i++) {
+        c = _mm256_loadu_si256((const __m256i*)(p + 32*i));
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}'
+        l = _mm256_or_si256(c, lower);
+        op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(l, obrace), _mm256_cmpeq_epi8(l, cbrace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, colon), _mm256_cmpeq_epi8(c, comma)));
+        ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, space), _mm256_cmpeq_epi8(c, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, lf), _mm256_cmpeq_epi8(c, cr)));
+
+        b->op    |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << (32*i);
+        b->ws    |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << (32*i);
+        b->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, quote)) << (32*i);
+        b->bs    |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, bs)) << (32*i);
+    }
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+static void jcsn_classify(const char *p, Jcsn_Block *b) {
+    const __m128i obrace = _mm_set1_epi8('{'), cbrace = _mm_set1_epi8('}');
+    const __m128i colon  = _mm_set1_epi8(':'), comma  = _mm_set1_epi8(',');
+    const __m128i space  = _mm_set1_epi8(' '), tab    = _mm_set1_epi8('\t');
+    const __m128i lf     = _mm_set1_epi8('\n'), cr    = _mm_set1_epi8('\r');
+    const __m128i quote  = _mm_set1_epi8('\"'), bs    = _mm_set1_epi8('\\');
+    const __m128i lower  = _mm_set1_epi8(0x20);
+    __m128i c, l, op, ws;
+    int i;
+
+    *b = (Jcsn_Block) { 0 };
+    for (i = 0; i < 4; i++) {
+        c = _mm_loadu_si128((const __m128i*)(p + 16*i));
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}'
+        l = _mm_or_si128(c, lower);
+        op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(l, obrace), _mm_cmpeq_epi8(l, cbrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(c, colon), _mm_cmpeq_epi8(c, comma)));
+        ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, space), _mm_cmpeq_epi8(c, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(c, lf), _mm_cmpeq_epi8(c, cr)));
+
+        b->op    |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << (16*i);
+        b->ws    |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << (16*i);
+        b->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, quote)) << (16*i);
+        b->bs    |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, bs)) << (16*i);
+    }
+}
+
+#else
+
+static void jcsn_classify(const char *p, Jcsn_Block *b) {
+    uint64_t bit;
+    int i;
+
+    *b = (Jcsn_Block) { 0 };
+    for (i = 0; i < JCSN_BLOCK_SIZE; i++) {
+        bit = 1ULL << i;
+        switch (p[i]) {
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                b->op |= bit;
+                break;
+
+            case ' ': case '\t': case '\n': case '\r':
+                b->ws |= bit;
+                break;
+
+            case '\"':
+                b->quote |= bit;
+                break;
+
+            case '\\':
+                b->bs |= bit;
+                break;
+
+            default: break;
+        }
+    }
+}
+
+#endif // __AVX2__
+
+
+// Bit N of result is the xor of bits 0..N of `x`.
+// Used to turn a bitmap of quotes into a bitmap of string contents.
+static uint64_t jcsn_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+
+// Find characters that are escaped by a backslash.
+// An odd length run of backslashes escapes the character after it. Runs
+// starting on even and odd bits are told apart by adding the run starts
+// to the backslash bitmap, which carries through each run.
+static uint64_t jcsn_find_escaped(uint64_t bs, uint64_t *prev_escaped) {
+    const uint64_t even = 0x5555555555555555ULL;
+    uint64_t follows, odd_starts, even_seqs;
+
+    // A backslash that is escaped itself does not start a run
+    bs &= ~(*prev_escaped);
+    follows = (bs << 1) | *prev_escaped;
+
+    odd_starts = bs & ~even & ~follows;
+    even_seqs = odd_starts + bs;
+    *prev_escaped = (even_seqs < odd_starts);
+
+    return (even ^ (even_seqs << 1)) & follows;
+}
+
+
+#if defined(__SSSE3__)
+
+// Utf-8 validation with lookup tables (Keiser and Lemire, "Validating
+// UTF-8 In Less Than One Instruction Per Byte"). Each error is a bit
+// set by three 16 entry tables indexed by high and low nibble of
+// previous byte and high nibble of current byte. A byte is invalid if
+// all three lookups agree on some error bit.
+#define JCSN_UTF8_TOO_SHORT   (1 << 0) // lead byte or ascii followed by lead byte
+#define JCSN_UTF8_TOO_LONG    (1 << 1) // ascii followed by continuation
+#define JCSN_UTF8_OVERLONG_3  (1 << 2) // 11100000 100_____
+#define JCSN_UTF8_TOO_LARGE   (1 << 3) // 11110100 1001____ and above
+#define JCSN_UTF8_SURROGATE   (1 << 4) // 11101101 101_____
+#define JCSN_UTF8_OVERLONG_2  (1 << 5) // 1100000_ 10______
+#define JCSN_UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and above
+#define JCSN_UTF8_OVERLONG_4  (1 << 6) // 11110000 1000____
+#define JCSN_UTF8_TWO_CONTS   (1 << 7) // continuation followed by continuation
+#define JCSN_UTF8_CARRY \
+    (JCSN_UTF8_TOO_SHORT | JCSN_UTF8_TOO_LONG | JCSN_UTF8_TWO_CONTS)
+
+#define JCSN_UTF8_LUT(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) \
+    _mm_setr_epi8((char)(a), (char)(b), (char)(c), (char)(d), \
+                  (char)(e), (char)(f), (char)(g), (char)(h), \
+                  (char)(i), (char)(j), (char)(k), (char)(l), \
+                  (char)(m), (char)(n), (char)(o), (char)(p))
+
+static __m128i jcsn_utf8_nibble_hi(__m128i v) {
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+
+static __m128i jcsn_utf8_check_block(__m128i in, __m128i prev) {
+    const __m128i byte_1_high_lut = JCSN_UTF8_LUT(
+        // 0_______ ________
+        JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG,
+        JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG, JCSN_UTF8_TOO_LONG,
+        // 10______ ________
+        JCSN_UTF8_TWO_CONTS, JCSN_UTF8_TWO_CONTS, JCSN_UTF8_TWO_CONTS, JCSN_UTF8_TWO_CONTS,
+        // 1100____ ________
+        JCSN_UTF8_TOO_SHORT | JCSN_UTF8_OVERLONG_2,
+        // 1101____ ________
+        JCSN_UTF8_TOO_SHORT,
+        // 1110____ ________
+        JCSN_UTF8_TOO_SHORT | JCSN_UTF8_OVERLONG_3 | JCSN_UTF8_SURROGATE,
+        // 1111____ ________
+        JCSN_UTF8_TOO_SHORT | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000 | JCSN_UTF8_OVERLONG_4);
+
+    const __m128i byte_1_low_lut = JCSN_UTF8_LUT(
+        // ____0000 ________
+        JCSN_UTF8_CARRY | JCSN_UTF8_OVERLONG_3 | JCSN_UTF8_OVERLONG_2 | JCSN_UTF8_OVERLONG_4,
+        // ____0001 ________
+        JCSN_UTF8_CARRY | JCSN_UTF8_OVERLONG_2,
+        // ____001_ ________
+        JCSN_UTF8_CARRY,
+        JCSN_UTF8_CARRY,
+        // ____0100 ________
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE,
+        // ____0101 ________ and above
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        // ____1101 ________
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000 | JCSN_UTF8_SURROGATE,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000,
+        JCSN_UTF8_CARRY | JCSN_UTF8_TOO_LARGE | JCSN_UTF8_TOO_LARGE_1000);
+
+    const __m128i byte_2_high_lut = JCSN_UTF8_LUT(
+        // ________ 0_______
+        JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT,
+        JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT,
+        // ________ 1000____
+        JCSN_UTF8_TOO_LONG | JCSN_UTF8_OVERLONG_2 | JCSN_UTF8_TWO_CONTS
+            | JCSN_UTF8_OVERLONG_3 | JCSN_UTF8_TOO_LARGE_1000 | JCSN_UTF8_OVERLONG_4,
+        // ________ 1001____
+        JCSN_UTF8_TOO_LONG | JCSN_UTF8_OVERLONG_2 | JCSN_UTF8_TWO_CONTS
+            | JCSN_UTF8_OVERLONG_3 | JCSN_UTF8_TOO_LARGE,
+        // ________ 101_____
+        JCSN_UTF8_TOO_LONG | JCSN_UTF8_OVERLONG_2 | JCSN_UTF8_TWO_CONTS
+            | JCSN_UTF8_SURROGATE | JCSN_UTF8_TOO_LARGE,
+        JCSN_UTF8_TOO_LONG | JCSN_UTF8_OVERLONG_2 | JCSN_UTF8_TWO_CONTS
+            | JCSN_UTF8_SURROGATE | JCSN_UTF8_TOO_LARGE,
+        // ________ 11______
+        JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT, JCSN_UTF8_TOO_SHORT);
+
+    __m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+    __m128i prev2 = _mm_alignr_epi8(in, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(in, prev, 13);
+    __m128i sc, must23;
+
+    sc = _mm_and_si128(
+        _mm_and_si128(
+            _mm_shuffle_epi8(byte_1_high_lut, jcsn_utf8_nibble_hi(prev1)),
+            _mm_shuffle_epi8(byte_1_low_lut, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+        _mm_shuffle_epi8(byte_2_high_lut, jcsn_utf8_nibble_hi(in)));
+
+    // Third and fourth bytes of a sequence must be continuations.
+    // Only 111_____ and 1111____ have high bit set after subtraction.
+    must23 = _mm_or_si128(
+        _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+        _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+    must23 = _mm_and_si128(must23, _mm_set1_epi8((char)0x80));
+
+    return _mm_xor_si128(must23, sc);
+}
+
+#else
+
+// Length of a utf-8 sequence by its lead byte and valid range of its
+// second byte (first continuation). Zero length means invalid lead byte.
+static int jcsn_utf8_lead(unsigned char ch, unsigned char *lo, unsigned char *hi) {
+    *lo = 0x80;
+    *hi = 0xBF;
+    if (ch >= 0xC2 && ch <= 0xDF)
+        return 2;
+    if (ch >= 0xE0 && ch <= 0xEF) {
+        if (ch == 0xE0)
+            *lo = 0xA0;
+        else if (ch == 0xED)
+            *hi = 0x9F;
+        return 3;
+    }
+    if (ch >= 0xF0 && ch <= 0xF4) {
+        if (ch == 0xF0)
+            *lo = 0x90;
+        else if (ch == 0xF4)
+            *hi = 0x8F;
+        return 4;
+    }
+    return 0;
+}
+
+
+static int jcsn_utf8_valid_scalar(const unsigned char *s, size_t len) {
+    unsigned char lo, hi;
+    size_t i = 0;
+    int n, k;
+
+    while (i < len) {
+        if (s[i] < 0x80) {
+            i += 1;
+            continue;
+        }
+        n = jcsn_utf8_lead(s[i], &lo, &hi);
+        if (n == 0 || len - i < (size_t)n)
+            return 0;
+        if (s[i+1] < lo || s[i+1] > hi)
+            return 0;
+        for (k = 2; k < n; k++)
+            if ((s[i+k] & 0xC0) != 0x80)
+                return 0;
+        i += n;
+    }
+    return 1;
+}
+
+#endif // __SSSE3__
+
+
+// Classify the block at `sc->next` and fill `sc->bits`
+static void jcsn_scanner_fill(Jcsn_Scanner *sc) {
+    char pad[JCSN_BLOCK_SIZE];
+    const char *p = sc->buf + sc->next;
+    uint64_t escaped, quote, in_string, scalar;
+    Jcsn_Block b;
+
+    // Last block is padded with whitespaces
+    if (sc->len - sc->next < JCSN_BLOCK_SIZE) {
+        memset(pad, ' ', sizeof(pad));
+        memcpy(pad, p, sc->len - sc->next);
+        p = pad;
+    }
+    jcsn_classify(p, &b);
+
+    escaped = jcsn_find_escaped(b.bs, &sc->prev_escaped);
+    quote = b.quote & ~escaped;
+
+    // Opening quote is inside the string, closing quote is not
+    in_string = jcsn_prefix_xor(quote) ^ sc->prev_in_string;
+    sc->prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+
+    scalar = ~(b.op | b.ws | quote) & ~in_string;
+
+    sc->bits  = (b.op & ~in_string) | (quote & in_string);
+    sc->bits |= scalar & ~((scalar << 1) | sc->prev_scalar);
+    sc->prev_scalar = scalar >> 63;
+
+    sc->block = sc->next;
+    sc->next += JCSN_BLOCK_SIZE;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+void jcsn_scanner_init(Jcsn_Scanner *sc, const char *buf, size_t len) {
+    *sc = (Jcsn_Scanner) {
+        .buf = buf,
+        .len = len,
+        .block = 0,
+        .next = 0,
+        .bits = 0,
+        .prev_escaped = 0,
+        .prev_in_string = 0,
+        .prev_scalar = 0,
+    };
+}
+
+
+size_t jcsn_scanner_next(Jcsn_Scanner *sc) {
+    size_t off;
+
+    while (sc->bits == 0) {
+        if (sc->next >= sc->len)
+            return sc->len;
+        jcsn_scanner_fill(sc);
+    }
+
+    off = sc->block + (size_t)jcsn_ctz64(sc->bits);
+    // clear lowest set bit
+    sc->bits &= sc->bits - 1;
+    return off;
+}
+
+
+size_t jcsn_scanner_peek(Jcsn_Scanner *sc) {
+    size_t off = jcsn_scanner_next(sc);
+    // `off` is in current block, put it's bit back
+    if (off < sc->len)
+        sc->bits |= 1ULL << (off - sc->block);
+    return off;
+}
+
+
+void jcsn_scanner_seek(Jcsn_Scanner *sc, size_t off) {
+    // `off` is in current block, just drop positions before it
+    if (off < sc->next) {
+        if (off > sc->block)
+            sc->bits &= ~0ULL << (off - sc->block);
+        return;
+    }
+
+    // Otherwise start a new (unaligned) block at `off`
+    sc->bits = 0;
+    sc->next = off;
+    sc->prev_escaped = 0;
+    sc->prev_in_string = 0;
+    sc->prev_scalar = 0;
+}
+
+
+int jcsn_utf8_valid(const char *p, size_t len) {
+#if defined(__SSSE3__)
+    // Bytes that are incomplete if they are among last bytes of a block:
+    // a 2 byte lead in last byte, a 3 byte lead in last two bytes and a
+    // 4 byte lead in last three bytes.
+    const __m128i max = JCSN_UTF8_LUT(
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+    __m128i in, prev = _mm_setzero_si128();
+    __m128i err = _mm_setzero_si128(), incomplete = _mm_setzero_si128();
+    char tail[16];
+
+    for (; len >= 16; p += 16, len -= 16) {
+        in = _mm_loadu_si128((const __m128i*)p);
+        if (_mm_movemask_epi8(in) == 0) {
+            // ascii block, previous block must not end in a sequence
+            err = _mm_or_si128(err, incomplete);
+        } else {
+            err = _mm_or_si128(err, jcsn_utf8_check_block(in, prev));
+            incomplete = _mm_subs_epu8(in, max);
+        }
+        prev = in;
+    }
+
+    // Zero padding is ascii, so it also flags an unfinished sequence
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, p, len);
+    in = _mm_loadu_si128((const __m128i*)tail);
+    err = _mm_or_si128(err, jcsn_utf8_check_block(in, prev));
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(err, _mm_setzero_si128())) == 0xFFFF;
+#else
+    const unsigned char *s = (const unsigned char*)p;
+    size_t i = 0;
+
+    // skip leading ascii bytes 8 at a time
+    for (; len - i >= 8; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            break;
+    }
+    return jcsn_utf8_valid_scalar(s + i, len - i);
+#endif // __SSSE3__
+}
+
+
+const char *jcsn_scan_string(const char *p, const char *end) {
+    unsigned char ch;
+
+#if defined(__AVX2__)
+    const __m256i quote = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1f);
+    __m256i c, m;
+    uint32_t mask;
+
+    for (; end - p >= 32; p += 32) {
+        c = _mm256_loadu_si256((const __m256i*)p);
+        // c <= 0x1f (unsigned) if saturated subtraction is zero
+        m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(c, quote), _mm256_cmpeq_epi8(c, bs)),
+            _mm256_cmpeq_epi8(_mm256_subs_epu8(c, ctrl), _mm256_setzero_si256()));
+        mask = (uint32_t)_mm256_movemask_epi8(m);
+        if (mask)
+            return p + jcsn_ctz64(mask);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i quote = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    __m128i c, m;
+    uint32_t mask;
+
+    for (; end - p >= 16; p += 16) {
+        c = _mm_loadu_si128((const __m128i*)p);
+        // c <= 0x1f (unsigned) if saturated subtraction is zero
+        m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(c, quote), _mm_cmpeq_epi8(c, bs)),
+            _mm_cmpeq_epi8(_mm_subs_epu8(c, ctrl), _mm_setzero_si128()));
+        mask = (uint32_t)_mm_movemask_epi8(m);
+        if (mask)
+            return p + jcsn_ctz64(mask);
+    }
+#endif // __AVX2__
+
+    for (; p < end; p++) {
+        ch = (unsigned char)*p;
+        if (ch == '\"' || ch == '\\' || ch < 0x20)
+            break;
+    }
+    return p;
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
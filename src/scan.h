@@ -0,0 +1,107 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Structural Scanner Module
+ * Find structural characters in raw json data, a block at a time
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_SCAN_H
+#define __JACSON_SCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Macros and constants
+ */
+
+// Number of bytes classified at once
+#define JCSN_BLOCK_SIZE 64
+
+
+
+/**
+ * Types
+ */
+
+// The scanner classifies raw json data in blocks of `JCSN_BLOCK_SIZE`
+// bytes and keeps a bitmap of structural positions for the current
+// block. A structural position is one of:
+//   - `{`, `}`, `[`, `]`, `:` or `,` outside of a json string
+//   - the opening `"` of a json string
+//   - first character of a json number, `true`, `false` or `null`
+//
+// Everything else (whitespace and string contents) is never visited
+// by the lexer.
+typedef struct Jcsn_Scanner {
+    const char *buf;
+    size_t len;
+
+    // Offset of the current block in `buf`
+    size_t block;
+
+    // Offset of the next block to classify
+    size_t next;
+
+    // Structural positions not consumed yet in current block
+    uint64_t bits;
+
+    // State carried between blocks
+    uint64_t prev_escaped;   // last byte of previous block was an escape
+    uint64_t prev_in_string; // all ones if previous block ended inside a string
+    uint64_t prev_scalar;    // last byte of previous block was part of a scalar
+} Jcsn_Scanner;
+
+
+
+/**
+ * Module Public API
+ */
+
+// Initialize a scanner over `len` bytes of raw json data
+void jcsn_scanner_init(Jcsn_Scanner *sc, const char *buf, size_t len);
+
+// Get offset of next structural position.
+// Returns `sc->len` when there is nothing left to scan.
+size_t jcsn_scanner_next(Jcsn_Scanner *sc);
+
+// Get offset of next structural position without consuming it
+size_t jcsn_scanner_peek(Jcsn_Scanner *sc);
+
+// Continue scanning from `off`, which must be outside of any json string.
+// Bytes in between last reported position and `off` are never read
+// again, so the caller is free to modify them.
+void jcsn_scanner_seek(Jcsn_Scanner *sc, size_t off);
+
+// Find first character in [p, end) that ends an escape-free run of a
+// json string: `"`, backslash or a control character (< 0x20).
+// Returns `end` if there is no such character.
+const char *jcsn_scan_string(const char *p, const char *end);
+
+// Check that `len` bytes at `p` are valid utf-8.
+// 0 -> invalid utf-8
+// 1 -> everything is ok
+int jcsn_utf8_valid(const char *p, size_t len);
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_SCAN_H
@@ -0,0 +1,168 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Shape Module
+ * Share member names between json objects with the same names
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#ifdef __JCSN_TRACE__
+    #include <stdio.h>
+#endif // __JCSN_TRACE__
+#include <stdlib.h>
+
+// Jacson
+#include "log.h"
+#include "mem.h"
+#include "shape.h"
+
+
+
+/**
+ * Module Private API
+ */
+
+// Identity of an interned member name at absolute index `at` of pool
+// (or on parser's stack if `at` is 0). Names in raw json data are
+// identified by their address and names in the pool by their absolute
+// offset, with lowest bit set to keep them apart.
+static inline uint64_t jcsn_name_id(const Jcsn_JValue *name, size_t at) {
+    if (name->flags & JCSN_JVAL_POOLED)
+        return ((uint64_t)(name->data.off + (int64_t)(at * sizeof(*name))) << 1) | 1;
+    return (uint64_t)(uintptr_t)name->data.str << 1;
+}
+
+
+// Insert a slot into a table that has room for it
+static void jcsn_shapes_insert(Jcsn_Shape_Slot *slots, size_t cap, const Jcsn_Shape_Slot *slot) {
+    size_t mask = cap - 1, i;
+    for (i = slot->hash & mask; slots[i].len; i = (i + 1) & mask)
+        ;
+    slots[i] = *slot;
+}
+
+
+// Double number of slots
+static int jcsn_shapes_grow(Jcsn_Shapes *sh) {
+    size_t cap = (sh->cap) ? (sh->cap << 1) : 64;
+    Jcsn_Shape_Slot *slots = calloc(cap, sizeof(*slots));
+    if (!slots)
+        return 1;
+
+    for (size_t i = 0; i < sh->cap; i++)
+        if (sh->slots[i].len)
+            jcsn_shapes_insert(slots, cap, &sh->slots[i]);
+
+    xfree(sh->slots);
+    sh->slots = slots;
+    sh->cap = cap;
+    return 0;
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+void jcsn_shapes_init(Jcsn_Shapes *sh) {
+    *sh = (Jcsn_Shapes) {
+        .slots = NULL,
+        .len = 0,
+        .cap = 0,
+    };
+}
+
+
+uint32_t jcsn_shape_hash(const Jcsn_JValue *src, size_t n, size_t stride) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    for (size_t i = 0; i < n; i++, src += stride) {
+        h = (h ^ jcsn_name_id(src, 0)) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    return (uint32_t)h;
+}
+
+
+int64_t jcsn_shapes_find(const Jcsn_Shapes *sh,
+                         const Jcsn_Pool *pool,
+                         const Jcsn_JValue *src,
+                         size_t n,
+                         size_t stride,
+                         uint32_t hash)
+{
+    if (!sh->cap)
+        return -1;
+
+    size_t mask = sh->cap - 1, i, k;
+    const Jcsn_Shape_Slot *slot;
+    const Jcsn_JValue *names;
+
+    for (i = hash & mask; sh->slots[i].len; i = (i + 1) & mask) {
+        slot = &sh->slots[i];
+        if (slot->hash != hash || slot->len != n)
+            continue;
+
+        names = &pool->nodes[slot->names];
+        for (k = 0; k < n; k++) {
+            if (names[k].len != src[k * stride].len
+                || jcsn_name_id(&names[k], slot->names + k) != jcsn_name_id(&src[k * stride], 0))
+                break;
+        }
+        if (k == n)
+            return slot->names;
+    }
+    return -1;
+}
+
+
+int jcsn_shapes_add(Jcsn_Shapes *sh, uint32_t hash, size_t n, size_t names) {
+    // keep load factor under 3/4
+    if ((sh->len + 1) * 4 > sh->cap * 3 && jcsn_shapes_grow(sh))
+        return 1;
+
+    Jcsn_Shape_Slot slot = {
+        .hash = hash,
+        .len = (uint32_t)n,
+        .names = (uint32_t)names,
+    };
+    jcsn_shapes_insert(sh->slots, sh->cap, &slot);
+    sh->len += 1;
+    return 0;
+}
+
+
+void jcsn_shapes_free(Jcsn_Shapes *sh) {
+    if (sh) {
+        xfree(sh->slots);
+        sh->len = 0;
+        sh->cap = 0;
+    }
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
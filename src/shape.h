@@ -0,0 +1,93 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Shape Module
+ * Share member names between json objects with the same names
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_SHAPE_H
+#define __JACSON_SHAPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jvalue.h"
+
+
+/**
+ * Types
+ */
+
+// Shape of a json object is it's list of member names, in order. Names
+// of the first json object of a shape are placed in the node pool (with
+// a hash index if it has one) and every later json object of that shape
+// uses them instead of placing it's own.
+typedef struct Jcsn_Shape_Slot {
+    uint32_t hash;
+
+    // Number of names (0 -> empty slot)
+    uint32_t len;
+
+    // Absolute index of names in the pool
+    uint32_t names;
+} Jcsn_Shape_Slot;
+
+
+// Hash set of shapes seen while parsing a document (open addressing,
+// linear probing). Member names must be interned, so they are compared
+// by address.
+typedef struct Jcsn_Shapes {
+    Jcsn_Shape_Slot *slots;
+    size_t len;
+    size_t cap;
+} Jcsn_Shapes;
+
+
+
+/**
+ * Module Public API
+ */
+
+// Initialize an empty table
+void jcsn_shapes_init(Jcsn_Shapes *sh);
+
+// Hash `n` member names, one every `stride` nodes of `src`
+uint32_t jcsn_shape_hash(const Jcsn_JValue *src, size_t n, size_t stride);
+
+// Find names in `pool` equal to `n` names of `src` (one every `stride`
+// nodes). Returns their absolute index or -1 if there is no such shape.
+int64_t jcsn_shapes_find(const Jcsn_Shapes *sh,
+                         const Jcsn_Pool *pool,
+                         const Jcsn_JValue *src,
+                         size_t n,
+                         size_t stride,
+                         uint32_t hash);
+
+// Add a shape of `n` names at absolute index `names` of pool
+// 0 -> ok
+// 1 -> out of memory
+int jcsn_shapes_add(Jcsn_Shapes *sh, uint32_t hash, size_t n, size_t names);
+
+// Free memory of table
+void jcsn_shapes_free(Jcsn_Shapes *sh);
+
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_SHAPE_H
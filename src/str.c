@@ -60,7 +60,8 @@ int jcsn_string_append(Jcsn_String *jstr, const char *s, size_t slen) {
     // include null terminator while allocating more memory
     slen += 1;
     if ((jstr->cap - jstr->len) < slen) {
-        jstr->cap <<= 1;
+        while ((jstr->cap - jstr->len) < slen)
+            jstr->cap <<= 1;
         void *tmp = realloc(jstr->data, (sizeof(char) * jstr->cap));
         if (!tmp)
             return 1;
@@ -180,6 +181,30 @@ ret:
 }
 
 
+// Mixes 8 bytes at a time with a multiply and a shift, then finalizes
+// like murmur3's 64-bit finalizer.
+uint32_t jcsn_string_hash(const char *s, size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ len, w;
+
+    for (; len >= 8; s += 8, len -= 8) {
+        memcpy(&w, s, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, s, len);
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -23,6 +23,9 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stddef.h>
+#include <stdint.h>
+
 
 
 /**
@@ -33,6 +36,10 @@ extern "C" {
     ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || ch == '\r')
 
 
+#define jcsn_char_is_structural(ch) \
+    ((ch) == '{' || (ch) == '}' || (ch) == '[' || (ch) == ']' || (ch) == ':' || (ch) == ',')
+
+
 #define jcsn_skip_whitespaces(ptr) \
     while ((**(ptr)) && ((jcsn_char_is_whitespace(**(ptr))))) *(ptr) += 1
 
@@ -77,6 +84,9 @@ char *jcsn_string_substring(const char *start, const char *end);
 // Parse a single integer value from string literal
 long jcsn_string_to_long(const char *s);
 
+// Hash `len` bytes of `s`. Not suitable against hash flooding.
+uint32_t jcsn_string_hash(const char *s, size_t len);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,316 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Tape Module
+ * Parse json data into a flat tape of 64-bit words
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+
+
+/**
+ * Includes
+ */
+
+// Standard Library
+#ifdef __JCSN_TRACE__
+    #include <stdio.h>
+#endif // __JCSN_TRACE__
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Jacson
+#include <jacson/jacson.h>
+#include "lexer.h"
+#include "validator.h"
+#include "tape.h"
+#include "mem.h"
+#include "log.h"
+
+
+
+/**
+ * Module Private API
+ */
+
+static int jcsn_tape_append(Jcsn_Tape *tape, uint64_t word) {
+    if (tape->len == tape->cap) {
+        tape->cap <<= 1;
+        void *tmp = realloc(tape->words, tape->cap * sizeof(*tape->words));
+        if (!tmp) {
+            JCSN_LOG_ERR("Failed to reallocate memory for tape\n", NULL);
+            return 1;
+        }
+        tape->words = tmp;
+    }
+    tape->words[tape->len] = word;
+    tape->len += 1;
+    return 0;
+}
+
+
+// copy a json string to string buffer and add it's words to tape
+static int jcsn_tape_append_string(Jcsn_Tape *tape, Jcsn_JString str) {
+    size_t off = tape->strs_len;
+
+    if (tape->strs_cap - tape->strs_len < str.len + 1) {
+        while (tape->strs_cap - tape->strs_len < str.len + 1)
+            tape->strs_cap <<= 1;
+        void *tmp = realloc(tape->strs, tape->strs_cap);
+        if (!tmp) {
+            JCSN_LOG_ERR("Failed to reallocate memory for tape strings\n", NULL);
+            return 1;
+        }
+        tape->strs = tmp;
+    }
+    memcpy(tape->strs + off, str.data, str.len);
+    tape->strs[off + str.len] = '\0';
+    tape->strs_len += str.len + 1;
+
+    if (jcsn_tape_append(tape, jcsn_tape_word('\"', off)))
+        return 1;
+    return jcsn_tape_append(tape, (uint64_t)str.len);
+}
+
+
+
+/**
+ * Module Public API
+ */
+
+// Parse json data into a tape in a single pass. Containers are written
+// when they open and patched with index of their end when they close.
+Jcsn_Tape *jcsn_tape_parse_raw(char *jdata, int flags) {
+    size_t len = strlen(jdata), open[JCSN_MAX_DEPTH], depth = 0, start;
+    uint64_t bits;
+    Jcsn_Lexer lexer;
+    Jcsn_Validator v;
+    Jcsn_Token tk;
+    int err = 0;
+
+    Jcsn_Tape *tape = malloc(sizeof(*tape));
+    if (!tape)
+        return NULL;
+
+    // Pre-size tape and string buffer from length of json data
+    *tape = (Jcsn_Tape) {
+        .words = NULL,
+        .len = 0,
+        .cap = (len >> 3) + 16,
+        .strs = NULL,
+        .strs_len = 0,
+        .strs_cap = (len >> 2) + 64,
+    };
+    tape->words = malloc(tape->cap * sizeof(*tape->words));
+    tape->strs = malloc(tape->strs_cap);
+    if (!tape->words || !tape->strs) {
+        jcsn_tape_free(tape);
+        return NULL;
+    }
+
+    // Strings are copied to tape right away, before lexer reuses it's
+    // scratch buffer
+    jcsn_lexer_init(&lexer, jdata, len, flags);
+    jcsn_validator_init(&v);
+
+    while (1) {
+        if (jcsn_lexer_next(&lexer, &tk) || !jcsn_validator_feed(&v, tk.type)) {
+            err = 1;
+            break;
+        }
+        if (tk.type == TK_EOF)
+            break;
+
+        switch (tk.type) {
+            case '{':
+            case '[': {
+                // validator makes sure depth is never more than `JCSN_MAX_DEPTH`
+                open[depth++] = tape->len;
+                err = jcsn_tape_append(tape, jcsn_tape_word(tk.type, 0));
+            }
+            break;
+
+            case '}':
+            case ']': {
+                start = open[--depth];
+                tape->words[start] |= jcsn_tape_word(0, tape->len);
+                err = jcsn_tape_append(tape, jcsn_tape_word(tk.type, start));
+            }
+            break;
+
+            case TK_STRING:
+                err = jcsn_tape_append_string(tape, tk.value.string);
+                break;
+
+            case TK_INTEGER: {
+                err = jcsn_tape_append(tape, jcsn_tape_word('l', 0))
+                      || jcsn_tape_append(tape, (uint64_t)tk.value.integer);
+            }
+            break;
+
+            case TK_REAL: {
+                memcpy(&bits, &tk.value.real, sizeof(bits));
+                err = jcsn_tape_append(tape, jcsn_tape_word('d', 0))
+                      || jcsn_tape_append(tape, bits);
+            }
+            break;
+
+            case TK_BOOL:
+                err = jcsn_tape_append(tape, jcsn_tape_word((tk.value.boolean) ? 't' : 'f', 0));
+                break;
+
+            case TK_NULL:
+                err = jcsn_tape_append(tape, jcsn_tape_word('n', 0));
+                break;
+
+            default: break;
+        } // end switch (tk.type)
+
+        if (err)
+            break;
+    } // end while loop
+
+    jcsn_lexer_free(&lexer);
+    if (err) {
+        JCSN_LOG_ERR("Provided json data is not valid\n", NULL);
+        jcsn_tape_free(tape);
+        return NULL;
+    }
+    return tape;
+}
+
+
+void jcsn_tape_free(Jcsn_Tape *tape) {
+    if (!tape)
+        return;
+    xfree(tape->words);
+    xfree(tape->strs);
+    xfree(tape);
+}
+
+
+size_t jcsn_tape_root(const Jcsn_Tape *t) {
+    return (t && t->len) ? 0 : JCSN_TAPE_NONE;
+}
+
+
+enum Jcsn_JVal_T jcsn_tape_type(const Jcsn_Tape *t, size_t idx) {
+    if (idx >= t->len)
+        return J_NULL;
+    switch (jcsn_tape_word_type(t->words[idx])) {
+        case '{': return J_OBJECT;
+        case '[': return J_ARRAY;
+        case '\"': return J_STRING;
+        case 'l': return J_INTEGER;
+        case 'd': return J_REAL;
+        case 't':
+        case 'f': return J_BOOL;
+        default:  return J_NULL;
+    }
+}
+
+
+size_t jcsn_tape_child(const Jcsn_Tape *t, size_t idx) {
+    uint64_t w;
+    char type;
+
+    if (idx >= t->len)
+        return JCSN_TAPE_NONE;
+    w = t->words[idx];
+    type = jcsn_tape_word_type(w);
+    if (type != '{' && type != '[')
+        return JCSN_TAPE_NONE;
+    // empty json object/array ends right after it starts
+    if (jcsn_tape_word_payload(w) == idx + 1)
+        return JCSN_TAPE_NONE;
+    return idx + 1;
+}
+
+
+size_t jcsn_tape_skip(const Jcsn_Tape *t, size_t idx) {
+    uint64_t w;
+
+    if (idx >= t->len)
+        return JCSN_TAPE_NONE;
+    w = t->words[idx];
+    switch (jcsn_tape_word_type(w)) {
+        case '{':
+        case '[':
+            return jcsn_tape_word_payload(w) + 1;
+
+        case '\"':
+        case 'l':
+        case 'd':
+            return idx + 2;
+
+        default:
+            return idx + 1;
+    }
+}
+
+
+size_t jcsn_tape_next(const Jcsn_Tape *t, size_t idx) {
+    size_t next = jcsn_tape_skip(t, idx);
+    char type;
+
+    // `JCSN_TAPE_NONE` is past end of tape too
+    if (next >= t->len)
+        return JCSN_TAPE_NONE;
+    type = jcsn_tape_word_type(t->words[next]);
+    return (type == '}' || type == ']') ? JCSN_TAPE_NONE : next;
+}
+
+
+const char *jcsn_tape_string(const Jcsn_Tape *t, size_t idx, size_t *len) {
+    uint64_t w;
+
+    if (idx >= t->len)
+        return NULL;
+    w = t->words[idx];
+    if (jcsn_tape_word_type(w) != '\"')
+        return NULL;
+    if (len)
+        *len = (size_t)t->words[idx + 1];
+    return t->strs + jcsn_tape_word_payload(w);
+}
+
+
+long jcsn_tape_integer(const Jcsn_Tape *t, size_t idx) {
+    if (idx >= t->len || jcsn_tape_word_type(t->words[idx]) != 'l')
+        return 0;
+    return (long)t->words[idx + 1];
+}
+
+
+double jcsn_tape_real(const Jcsn_Tape *t, size_t idx) {
+    double d;
+    if (idx >= t->len || jcsn_tape_word_type(t->words[idx]) != 'd')
+        return 0.0;
+    memcpy(&d, &t->words[idx + 1], sizeof(d));
+    return d;
+}
+
+
+bool jcsn_tape_bool(const Jcsn_Tape *t, size_t idx) {
+    return idx < t->len && jcsn_tape_word_type(t->words[idx]) == 't';
+}
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
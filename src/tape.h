@@ -0,0 +1,87 @@
+/**
+ * Jacson
+ *
+ * Author: Hossein Khosravi (https://github.com/thehxdev)
+ * Description: Json processing library in C.
+ * Git: https://github.com/thehxdev/jacson
+ *
+ * ------------------------------------------------------------ *
+ * Tape Module
+ * Parse json data into a flat tape of 64-bit words
+ * ------------------------------------------------------------ *
+ *
+ * Jacson is developed under MIT License. You can find a copy
+ * of license information in the project's github repository:
+ * https://github.com/thehxdev/jacson/blob/main/LICENSE
+ */
+
+#ifndef __JACSON_TAPE_H
+#define __JACSON_TAPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+#include <jacson/jacson.h>
+
+
+/**
+ * Macros and constants
+ */
+
+// Each word of tape has a type character in it's high 8 bits and a
+// 56-bit payload:
+//   '{' '[' -> index of matching '}' or ']' word
+//   '}' ']' -> index of matching '{' or '[' word
+//   '"'     -> offset of string in string buffer, next word is it's length
+//   'l' 'd' -> nothing, next word is the long/double value
+//   't' 'f' 'n' -> nothing
+#define JCSN_TAPE_PAYLOAD_BITS 56
+#define JCSN_TAPE_PAYLOAD_MASK ((UINT64_C(1) << JCSN_TAPE_PAYLOAD_BITS) - 1)
+
+#define jcsn_tape_word(type, payload) \
+    (((uint64_t)(type) << JCSN_TAPE_PAYLOAD_BITS) | ((uint64_t)(payload) & JCSN_TAPE_PAYLOAD_MASK))
+
+#define jcsn_tape_word_type(w)    ((char)((w) >> JCSN_TAPE_PAYLOAD_BITS))
+#define jcsn_tape_word_payload(w) ((size_t)((w) & JCSN_TAPE_PAYLOAD_MASK))
+
+
+
+/**
+ * Types
+ */
+
+// Json data as one contiguous array of words. Values are laid out in
+// document order, so walking the tape is a sequential memory access.
+// Object members are a string word (name) followed by the value.
+struct Jcsn_Tape {
+    uint64_t *words;
+    size_t len;
+    size_t cap;
+
+    // Null terminated copies of all json strings
+    char *strs;
+    size_t strs_len;
+    size_t strs_cap;
+};
+
+
+
+/**
+ * Module Public API
+ */
+
+// Parse json data into a tape
+Jcsn_Tape *jcsn_tape_parse_raw(char *jdata, int flags);
+
+// Free all memory used by tape
+void jcsn_tape_free(Jcsn_Tape *tape);
+
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __JACSON_TAPE_H
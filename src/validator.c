@@ -19,26 +19,27 @@
 /**
  * What we're trying to validate?
  *
- *  1. First token in token list must be '{' or '['. Any valid json data starts by
- *     a json object or json array. everything else is invalid.
+ * Full json grammar (RFC 8259):
  *
- *  2. After each json value must be a ',' value except for the last one in json object/array.
+ *  1. Json data is a single json value. Nothing comes after it.
  *
- *  3. After each string in json object that comes after a ',' character, must be
- *     a ':' character.
+ *  2. Json object members are a string, a ':' character and a value.
+ *     Members and array elements are separated by ',' characters and
+ *     there is no ',' after the last one.
  *
- *  4. Check for '{}' and '[]' characters to match each other.
+ *  3. Check for '{}' and '[]' characters to match each other.
+ *
+ * Lexer already checks each token on it's own (strings, numbers and
+ * literals). Validator only checks the order of tokens with a table
+ * driven state machine and a stack of open objects/arrays. Tokens are
+ * validated one by one while they are consumed, so there is no need to
+ * keep them in memory.
  */
 
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
-/* FIXME:
- * Validator is very simple at this point and does not check
- * everything in json syntax. This is a note to improve the 
- * validator to do more advanced checks.
- */
 
 
 /**
@@ -49,111 +50,219 @@ extern "C" {
 #ifdef __JCSN_TRACE__
     #include <stdio.h>
 #endif // __JCSN_TRACE__
-#include <stdlib.h>
+#include <stdint.h>
 
 // Jacson
+#include <jacson/jacson.h>
 #include "lexer.h"
+#include "validator.h"
 #include "log.h"
 
 
+
+/**
+ * Types
+ */
+
+// Token classes, columns of grammar table
+enum Jcsn_Token_Class {
+    JCSN_TC_INVALID,
+    JCSN_TC_OBJ_BEG,
+    JCSN_TC_OBJ_END,
+    JCSN_TC_ARR_BEG,
+    JCSN_TC_ARR_END,
+    JCSN_TC_COLON,
+    JCSN_TC_COMMA,
+    JCSN_TC_STRING,
+    JCSN_TC_SCALAR,
+    JCSN_TC_EOF,
+
+    JCSN_TC_COUNT,
+};
+
+
+// An entry of grammar table is either the next state (`Jcsn_Expect`)
+// or one of these actions that need the depth stack.
+enum Jcsn_Grammar_Action {
+    JCSN_ACT_ERROR = JCSN_EXPECT_COUNT,
+    JCSN_ACT_PUSH_OBJ,
+    JCSN_ACT_PUSH_ARR,
+    JCSN_ACT_POP_OBJ,
+    JCSN_ACT_POP_ARR,
+    JCSN_ACT_NEXT, // next object member or array element
+};
+
+
+
 /**
  * Module Private API
  */
 
+#define X   JCSN_ACT_ERROR
+#define PO  JCSN_ACT_PUSH_OBJ
+#define PA  JCSN_ACT_PUSH_ARR
+#define EO  JCSN_ACT_POP_OBJ
+#define EA  JCSN_ACT_POP_ARR
+#define NX  JCSN_ACT_NEXT
+#define V   JCSN_EXPECT_VALUE
+#define C   JCSN_EXPECT_COLON
+#define CE  JCSN_EXPECT_COMMA_OR_END
+#define F   JCSN_EXPECT_EOF
+
+static const unsigned char jcsn_grammar[JCSN_EXPECT_COUNT][JCSN_TC_COUNT] = {
+    //                             inv  {   }   [   ]   :   ,  str scalar eof
+    [JCSN_EXPECT_ROOT]         = { X,  PO, X,  PA, X,  X,  X,  F,  F,  X },
+    [JCSN_EXPECT_VALUE]        = { X,  PO, X,  PA, X,  X,  X,  CE, CE, X },
+    [JCSN_EXPECT_VALUE_OR_END] = { X,  PO, X,  PA, EA, X,  X,  CE, CE, X },
+    [JCSN_EXPECT_KEY]          = { X,  X,  X,  X,  X,  X,  X,  C,  X,  X },
+    [JCSN_EXPECT_KEY_OR_END]   = { X,  X,  EO, X,  X,  X,  X,  C,  X,  X },
+    [JCSN_EXPECT_COLON]        = { X,  X,  X,  X,  X,  V,  X,  X,  X,  X },
+    [JCSN_EXPECT_COMMA_OR_END] = { X,  X,  EO, X,  EA, X,  NX, X,  X,  X },
+    [JCSN_EXPECT_EOF]          = { X,  X,  X,  X,  X,  X,  X,  X,  X,  F },
+};
+
+#undef X
+#undef PO
+#undef PA
+#undef EO
+#undef EA
+#undef NX
+#undef V
+#undef C
+#undef CE
+#undef F
+
+
+// Token types are characters or small enum values, map them to classes
+static const unsigned char jcsn_token_class[128] = {
+    ['{']        = JCSN_TC_OBJ_BEG,
+    ['}']        = JCSN_TC_OBJ_END,
+    ['[']        = JCSN_TC_ARR_BEG,
+    [']']        = JCSN_TC_ARR_END,
+    [':']        = JCSN_TC_COLON,
+    [',']        = JCSN_TC_COMMA,
+    [TK_STRING]  = JCSN_TC_STRING,
+    [TK_INTEGER] = JCSN_TC_SCALAR,
+    [TK_REAL]    = JCSN_TC_SCALAR,
+    [TK_BOOL]    = JCSN_TC_SCALAR,
+    [TK_NULL]    = JCSN_TC_SCALAR,
+    [TK_EOF]     = JCSN_TC_EOF,
+};
+
+
+#ifdef __JCSN_TRACE__
+// Why a token is rejected in each state
+static const char *jcsn_expect_msg[JCSN_EXPECT_COUNT] = {
+    [JCSN_EXPECT_ROOT]         = "Expected a json value",
+    [JCSN_EXPECT_VALUE]        = "Expected a json value",
+    [JCSN_EXPECT_VALUE_OR_END] = "Expected a json value or \']\' character",
+    [JCSN_EXPECT_KEY]          = "Expected a json string as json object member name",
+    [JCSN_EXPECT_KEY_OR_END]   = "Expected a json string as json object member name or \'}\' character",
+    [JCSN_EXPECT_COLON]        = "Expected \':\' character after json object member name",
+    [JCSN_EXPECT_COMMA_OR_END] = "Expected \',\' character or end of json object/array",
+    [JCSN_EXPECT_EOF]          = "Found extra data after end of json data",
+};
+#endif // __JCSN_TRACE__
+
+
+// is innermost open data collection a json object?
+static inline int jcsn_validator_in_object(Jcsn_Validator *v) {
+    unsigned long d = v->depth - 1;
+    return (int)((v->stack[d >> 6] >> (d & 63)) & 1);
+}
+
 
 
 /**
  * Module Public API
  */
 
-// validate json tokens
-// 0 -> found invalid token(s)
-// 1 -> everything is ok
-int jcsn_validate_tokens(Jcsn_TList *tlist) {
-    if (tlist == NULL)
-        return 0;
+void jcsn_validator_init(Jcsn_Validator *v) {
+    v->expect = JCSN_EXPECT_ROOT;
+    v->depth = 0;
+}
 
-    int stat = 1;
-    size_t len = tlist->len, i;
-    long brace_nest = 0, bracket_nest = 0;
-    register Jcsn_Token *tks = tlist->tokens, *curr = &tks[0], *prev, *next;
-
-    // Check first token
-    // It must be one of '[' or '{' characters.
-    switch(curr->type) {
-        case '{':
-        case '[':
-            break;
-
-        default: {
-            JCSN_LOG_ERR("Json data is not valid\n", NULL);
-            JCSN_LOG_ERR("Expected \'{\' or \'[\' characters as first token\n", NULL);
-            return 0;
-        }
+
+int jcsn_validator_feed(Jcsn_Validator *v, enum Jcsn_Token_Type type) {
+    unsigned char tc, next;
+    unsigned long d;
+    uint64_t bit;
+
+    tc = ((unsigned)type < sizeof(jcsn_token_class)) ? jcsn_token_class[type] : JCSN_TC_INVALID;
+    next = jcsn_grammar[v->expect][tc];
+    if (next < JCSN_EXPECT_COUNT) {
+        v->expect = (enum Jcsn_Expect)next;
+        return 1;
     }
 
+    switch (next) {
+        case JCSN_ACT_PUSH_OBJ:
+        case JCSN_ACT_PUSH_ARR: {
+            if (v->depth == JCSN_MAX_DEPTH) {
+                JCSN_LOG_ERR("Json data is nested deeper than %d levels\n", JCSN_MAX_DEPTH);
+                return 0;
+            }
+            d = v->depth;
+            bit = UINT64_C(1) << (d & 63);
+            if (next == JCSN_ACT_PUSH_OBJ) {
+                v->stack[d >> 6] |= bit;
+                v->expect = JCSN_EXPECT_KEY_OR_END;
+            } else {
+                v->stack[d >> 6] &= ~bit;
+                v->expect = JCSN_EXPECT_VALUE_OR_END;
+            }
+            v->depth += 1;
+        }
+        return 1;
+
+        case JCSN_ACT_POP_OBJ:
+        case JCSN_ACT_POP_ARR: {
+            if (jcsn_validator_in_object(v) != (next == JCSN_ACT_POP_OBJ)) {
+                JCSN_LOG_ERR("Json object/array ending does not match it's beginning\n", NULL);
+                return 0;
+            }
+            v->depth -= 1;
+            v->expect = (v->depth) ? JCSN_EXPECT_COMMA_OR_END : JCSN_EXPECT_EOF;
+        }
+        return 1;
+
+        case JCSN_ACT_NEXT: {
+            v->expect = (jcsn_validator_in_object(v)) ? JCSN_EXPECT_KEY : JCSN_EXPECT_VALUE;
+        }
+        return 1;
+
+        default: break;
+    } // end switch (next)
 
-    for (i = 0; i < len; i++) {
-        prev = jcsn_tlist_get(tks, len, i-1);
-        curr = jcsn_tlist_get(tks, len, i);
-        next = jcsn_tlist_get(tks, len, i+1);
-
-        switch (curr->type) {
-            case '{': {
-                if (next->type != TK_STRING && next->type != '}') {
-                    JCSN_LOG_ERR("Expected json string or \'}\' after \'{\' character\n", NULL);
-                    stat = 0;
-                    goto ret;
-                }
-                brace_nest += 1;
-            } break;
-
-            case '[': {
-                bracket_nest += 1;
-            } break;
-
-            case '}': {
-                if (prev->type == ',') {
-                    JCSN_LOG_ERR("Found extra \',\' character befor json object ending\n", NULL);
-                    stat = 0;
-                    goto ret;
-                }
-                brace_nest -= 1;
-            } break;
-
-            case ']': {
-                if (prev->type == ',') {
-                    JCSN_LOG_ERR("Found extra \',\' character befor json array ending\n", NULL);
-                    stat = 0;
-                    goto ret;
-                }
-                bracket_nest -= 1;
-            } break;
-
-            case ':': {
-                if (prev->type != TK_STRING) {
-                    JCSN_LOG_ERR("Expected json string befor \':\' character\n", NULL);
-                    stat = 0;
-                    goto ret;
-                }
-                if (next->type == ',') {
-                    JCSN_LOG_ERR("Expected json value after \':\' character but \',\' found\n", NULL);
-                    stat = 0;
-                    goto ret;
-                }
-            } break;
-
-            default: break;
-        } // end switch(curr->type)
-    } // end for loop
-
-    if (brace_nest != 0 || bracket_nest != 0) {
-        JCSN_LOG_ERR("Extra braces/brackets found in json data\n", NULL);
-        stat = 0;
+    if (type == TK_EOF) {
+        JCSN_LOG_ERR("Unexpected end of json data\n", NULL);
+    } else {
+        JCSN_LOG_ERR("%s\n", jcsn_expect_msg[v->expect]);
     }
+    return 0;
+}
+
+
+int jcsn_validate_raw(const char *jdata, size_t len) {
+    Jcsn_Lexer lexer;
+    Jcsn_Validator v;
+    Jcsn_Token tk;
+
+    if (!jdata)
+        return 0;
+
+    // Lexer never writes to json data or allocates in validate-only mode
+    jcsn_lexer_init(&lexer, (char*)jdata, len,
+                    JCSN_LEX_VALIDATE_ONLY | JCSN_PARSE_VALIDATE_UTF8);
+    jcsn_validator_init(&v);
+    do {
+        if (jcsn_lexer_next(&lexer, &tk))
+            return 0;
+        if (!jcsn_validator_feed(&v, tk.type))
+            return 0;
+    } while (tk.type != TK_EOF);
 
-ret:
-    return stat;
+    return 1;
 }
 
 
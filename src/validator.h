@@ -22,8 +22,67 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stddef.h>
+#include <stdint.h>
+#include "lexer.h"
 
-int jcsn_validate_tokens(Jcsn_TList *tlist);
+
+/**
+ * Macros and constants
+ */
+
+// Maximum nesting depth of json objects/arrays
+#define JCSN_MAX_DEPTH 1024
+
+
+
+/**
+ * Types
+ */
+
+// What validator accepts as next token (states of the grammar)
+enum Jcsn_Expect {
+    JCSN_EXPECT_ROOT,
+    JCSN_EXPECT_VALUE,
+    JCSN_EXPECT_VALUE_OR_END,
+    JCSN_EXPECT_KEY,
+    JCSN_EXPECT_KEY_OR_END,
+    JCSN_EXPECT_COLON,
+    JCSN_EXPECT_COMMA_OR_END,
+    JCSN_EXPECT_EOF,
+
+    JCSN_EXPECT_COUNT,
+};
+
+
+// Validator is a pushdown automaton that is fed one token at a time.
+// It never allocates, depth stack has a fixed size.
+typedef struct Jcsn_Validator {
+    enum Jcsn_Expect expect;
+    unsigned long depth;
+
+    // One bit per open data collection: 1 for objects, 0 for arrays
+    uint64_t stack[JCSN_MAX_DEPTH / 64];
+} Jcsn_Validator;
+
+
+
+/**
+ * Module Public API
+ */
+
+void jcsn_validator_init(Jcsn_Validator *v);
+
+// Feed next token type to validator. Feed `TK_EOF` at the end of
+// json data to make sure nothing is left open.
+// 0 -> found invalid token
+// 1 -> everything is ok
+int jcsn_validator_feed(Jcsn_Validator *v, enum Jcsn_Token_Type type);
+
+// Validate `len` bytes of raw json data without building an AST.
+// 0 -> invalid json data
+// 1 -> everything is ok
+int jcsn_validate_raw(const char *jdata, size_t len);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <jacson/jacson.h>
+
+// Aggregate test.
+// Reductions of json arrays must be the same whether arrays are packed
+// (`JCSN_PARSE_PACK_NUMBERS`) or not, so document is parsed both ways.
+// Sums of integers must be exact as long as the final sum fits a long,
+// however large the partial sums get, and report overflow otherwise.
+
+#define JDATA \
+    "{\"empty\": []," \
+    " \"max\": [9223372036854775807, -1, 1]," \
+    " \"over\": [9223372036854775807, 1]," \
+    " \"under\": [-9223372036854775808, -1]," \
+    " \"minmax\": [-9223372036854775808, 9223372036854775807]," \
+    " \"swing\": [9223372036854775807, 9223372036854775807, 9223372036854775807," \
+    "             -9223372036854775807, -9223372036854775807, -9223372036854775807]," \
+    " \"ints\": [5, -3, 7, 0, 2]," \
+    " \"reals\": [1.5, -2.5, 4.0, 0.25, 10.5]," \
+    " \"mixed\": [1, 2.5, \"x\", null, 3, true, {\"a\": 1}, [4]]," \
+    " \"none\": [\"x\", null]," \
+    " \"obj\": {\"a\": 1}}"
+
+// Expected reduction of a json array (`min`/`max` only if `count`)
+typedef struct StatCase {
+    const char *arr;
+    Jcsn_JStats st;
+} StatCase;
+
+// Expected result of a query that ends in a function (type is J_NULL if
+// there is no result)
+typedef struct FnCase {
+    const char *query;
+    enum Jcsn_JVal_T type;
+    long integer;
+    double real;
+} FnCase;
+
+
+static const StatCase stats[] = {
+    { "empty",  { .count = 0 } },
+    { "max",    { .count = 3, .sum = 9223372036854775807.0, .isum = LONG_MAX,
+                  .min = -1, .max = 9223372036854775807.0, .imin = -1, .imax = LONG_MAX } },
+    { "over",   { .count = 2, .sum = 9223372036854775808.0, .overflow = true,
+                  .min = 1, .max = 9223372036854775807.0, .imin = 1, .imax = LONG_MAX } },
+    { "under",  { .count = 2, .sum = -9223372036854775809.0, .overflow = true,
+                  .min = -9223372036854775808.0, .max = -1, .imin = LONG_MIN, .imax = -1 } },
+    { "minmax", { .count = 2, .sum = -1, .isum = -1,
+                  .min = -9223372036854775808.0, .max = 9223372036854775807.0, .imin = LONG_MIN, .imax = LONG_MAX } },
+    { "swing",  { .count = 6, .sum = 0, .isum = 0,
+                  .min = -9223372036854775807.0, .max = 9223372036854775807.0, .imin = -LONG_MAX, .imax = LONG_MAX } },
+    { "ints",   { .count = 5, .sum = 11, .isum = 11, .min = -3, .max = 7, .imin = -3, .imax = 7 } },
+    { "reals",  { .count = 5, .reals = 5, .sum = 13.75, .min = -2.5, .max = 10.5 } },
+    { "mixed",  { .count = 3, .reals = 1, .sum = 6.5, .isum = 4, .min = 1, .max = 3, .imin = 1, .imax = 3 } },
+    { "none",   { .count = 0 } },
+};
+
+static const FnCase fns[] = {
+    { "empty.count()",  J_INTEGER, 0, 0 },
+    { "empty.sum()",    J_INTEGER, 0, 0 },
+    { "empty.mean()",   J_NULL,    0, 0 },
+    { "empty.min()",    J_NULL,    0, 0 },
+    { "max.sum()",      J_INTEGER, LONG_MAX, 0 },
+    { "over.sum()",     J_REAL,    0, 9223372036854775808.0 },
+    { "swing.sum()",    J_INTEGER, 0, 0 },
+    { "ints.count()",   J_INTEGER, 5, 0 },
+    { "ints.sum()",     J_INTEGER, 11, 0 },
+    { "ints.min()",     J_INTEGER, -3, 0 },
+    { "ints.max()",     J_INTEGER, 7, 0 },
+    { "ints.mean()",    J_REAL,    0, 2.2 },
+    { "ints.avg()",     J_REAL,    0, 2.2 },
+    { "reals.sum()",    J_REAL,    0, 13.75 },
+    { "reals.min()",    J_REAL,    0, -2.5 },
+    { "reals.max()",    J_REAL,    0, 10.5 },
+    { "mixed.count()",  J_INTEGER, 3, 0 },
+    { "mixed.sum()",    J_REAL,    0, 6.5 },
+    { "mixed.min()",    J_REAL,    0, 1 },
+    { "mixed.max()",    J_REAL,    0, 3 },
+    { "mixed.mean()",   J_REAL,    0, 6.5 / 3 },
+    { "none.count()",   J_INTEGER, 0, 0 },
+    { "none.max()",     J_NULL,    0, 0 },
+    { "obj.sum()",      J_NULL,    0, 0 },
+    { "ints.median()",  J_NULL,    0, 0 },
+    { "nope.sum()",     J_NULL,    0, 0 },
+};
+
+
+static size_t check_stats(Jacson *j, const char *mode) {
+    const Jcsn_JStats *want;
+    Jcsn_JStats got;
+    double min, max;
+    size_t errors = 0;
+
+    for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) {
+        want = &stats[i].st;
+        got = jcsn_jarr_stats(jcsn_query_get(j, stats[i].arr));
+        if (got.count != want->count || got.reals != want->reals || got.sum != want->sum
+            || got.overflow != want->overflow || (!got.overflow && got.isum != want->isum)
+            || (got.count && (got.min != want->min || got.max != want->max))
+            || (got.count > got.reals && (got.imin != want->imin || got.imax != want->imax))
+            || jcsn_jarr_minmax(jcsn_query_get(j, stats[i].arr), &min, &max) != (want->count > 0)
+            || jcsn_jarr_sum(jcsn_query_get(j, stats[i].arr)) != want->sum)
+        {
+            printf("%s: stats of `%s` are wrong\n", mode, stats[i].arr);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+
+static size_t check_functions(Jacson *j, const char *mode) {
+    const Jcsn_JValue *v;
+    const FnCase *fn;
+    size_t errors = 0;
+    bool ok;
+
+    for (size_t i = 0; i < sizeof(fns) / sizeof(fns[0]); i++) {
+        fn = &fns[i];
+        v = jcsn_query_get(j, fn->query);
+        if (fn->type == J_NULL)
+            ok = (v == NULL);
+        else if (!v || v->type != fn->type)
+            ok = false;
+        else
+            ok = (fn->type == J_INTEGER) ? v->data.integer == fn->integer : v->data.real == fn->real;
+        if (!ok) {
+            printf("%s: `%s` is wrong\n", mode, fn->query);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+
+// A json array long enough for every lane of reduction loops
+static size_t check_long(int flags, const char *mode) {
+    char *jdata = malloc(32 * 1024), *p = jdata;
+    Jacson *j;
+    Jcsn_JStats st;
+    size_t errors = 0;
+
+    p += sprintf(p, "{\"i\": [");
+    for (int i = 1; i <= 1001; i++)
+        p += sprintf(p, "%s%d", (i > 1) ? ", " : "", (i % 2) ? i : -i);
+    p += sprintf(p, "], \"r\": [");
+    for (int i = 1; i <= 1001; i++)
+        p += sprintf(p, "%s%d.5", (i > 1) ? ", " : "", i);
+    p += sprintf(p, "]}");
+
+    j = jcsn_parse_json_flags(jdata, flags);
+    st = jcsn_jarr_stats(jcsn_query_get(j, "i"));
+    if (st.count != 1001 || st.isum != 501 || st.imin != -1000 || st.imax != 1001)
+        errors++;
+    st = jcsn_jarr_stats(jcsn_query_get(j, "r"));
+    if (st.count != 1001 || st.sum != 501501.0 + 500.5 || st.min != 1.5 || st.max != 1001.5)
+        errors++;
+    if (errors)
+        printf("%s: stats of long arrays are wrong\n", mode);
+
+    jcsn_free(j);
+    free(jdata);
+    return errors;
+}
+
+
+int main(void) {
+    static const struct { int flags; const char *name; } modes[] = {
+        { 0, "nodes" },
+        { JCSN_PARSE_PACK_NUMBERS, "packed" },
+    };
+    size_t errors = 0;
+    char *jdata;
+    Jacson *j;
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        jdata = strdup(JDATA);
+        j = jcsn_parse_json_flags(jdata, modes[m].flags);
+        if (!j) {
+            printf("%s: parsing failed\n", modes[m].name);
+            return 1;
+        }
+        errors += check_stats(j, modes[m].name);
+        errors += check_functions(j, modes[m].name);
+        errors += check_long(modes[m].flags, modes[m].name);
+        jcsn_free(j);
+        free(jdata);
+    }
+    printf("aggregates: %zu wrong results\n", errors);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <jacson/jacson.h>
+
+// Member name lookup benchmark.
+// Json objects with N members are looked up with `jcsn_jobj_get`, for
+// names that exist (hit) and names that don't (miss). Objects smaller
+// than `JCSN_JOBJ_INDEX_MIN` are scanned linearly, others through a hash
+// index built on first lookup.
+//
+// To find where a hash index starts to pay off, run it once against a
+// build where every object is indexed and once against a build where
+// none is, then compare the columns:
+//   cmake -B build-idx -DJOBJ_INDEX_MIN=1
+//   cmake -B build-lin -DJOBJ_INDEX_MIN=4294967295
+
+// Lookups done for each object size (fewer for big objects, so linear
+// scans of them finish in time)
+#define LOOKUPS(n) ((1 << 22) / (1 + (n) / 256))
+
+static const size_t sizes[] = {
+    1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64, 128, 256, 1024, 10000, 100000,
+};
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// json object with `n` members: {"field_0":0,"field_1":1,...}
+static char *make_object(size_t n) {
+    char *jdata = malloc(n * 32 + 3), *p = jdata;
+    assert(jdata != NULL && "malloc returned NULL");
+
+    *p++ = '{';
+    for (size_t i = 0; i < n; i++)
+        p += sprintf(p, "%s\"field_%zu\":%zu", (i) ? "," : "", i, i);
+    *p++ = '}';
+    *p = '\0';
+    return jdata;
+}
+
+
+// Average time of a lookup in nanoseconds
+static double bench_lookups(const Jcsn_JValue *obj, char **names, size_t n, int expect) {
+    size_t found = 0, count = LOOKUPS(n);
+    double start = now();
+    for (size_t i = 0; i < count; i++) {
+        const char *name = names[i % n];
+        found += (jcsn_jobj_get(obj, name, strlen(name)) != NULL);
+    }
+    double elapsed = now() - start;
+
+    assert(found == (expect ? count : 0) && "wrong lookup result");
+    return elapsed * 1e9 / count;
+}
+
+
+int main(void) {
+    printf("%10s %12s %12s %12s\n", "members", "first (us)", "hit (ns)", "miss (ns)");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        char *jdata = make_object(n);
+        Jacson *j = jcsn_parse_json(jdata);
+        assert(j != NULL && "jcsn_parse_json returned NULL");
+        const Jcsn_JValue *obj = jcsn_ast_root(j);
+
+        // names are looked up in a shuffled order
+        char **hits = malloc(sizeof(*hits) * n), **misses = malloc(sizeof(*misses) * n);
+        assert(hits && misses && "malloc returned NULL");
+        for (size_t i = 0; i < n; i++) {
+            hits[i] = malloc(32);
+            misses[i] = malloc(32);
+            snprintf(hits[i], 32, "field_%zu", i);
+            snprintf(misses[i], 32, "field_%zu_", i);
+        }
+        srand(42);
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t k = (size_t)rand() % (i + 1);
+            char *tmp = hits[i];
+            hits[i] = hits[k];
+            hits[k] = tmp;
+        }
+
+        double start = now();
+        (void)jcsn_jobj_get(obj, hits[0], strlen(hits[0]));
+        double first = (now() - start) * 1e6;
+
+        double hit = bench_lookups(obj, hits, n, 1);
+        double miss = bench_lookups(obj, misses, n, 0);
+        printf("%10zu %12.2f %12.2f %12.2f\n", n, first, hit, miss);
+
+        for (size_t i = 0; i < n; i++) {
+            free(hits[i]);
+            free(misses[i]);
+        }
+        free(hits);
+        free(misses);
+        jcsn_free(j);
+        free(jdata);
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <jacson/jacson.h>
+
+// Column extraction test.
+// Records of a json array come in a few shapes, with members in another
+// order, missing, of another type or not json objects at all. Every row
+// of every column is compared to what `jcsn_jobj_get` finds in it's
+// record: validity bit, null count and value (zero or empty if null).
+// String columns grow well past their first buffer.
+
+#define ROWS 500
+
+#define BIT(buf, i) (((const uint8_t*)(buf))[(i) / 8] >> ((i) % 8) & 1)
+
+
+static char *make_document(void) {
+    char *jdata = malloc(ROWS * 128 + 16), *p = jdata;
+    if (!jdata)
+        return NULL;
+
+    *p++ = '[';
+    for (int r = 0; r < ROWS; r++) {
+        if (r)
+            *p++ = ',';
+        switch (r % 6) {
+        case 0:
+            p += sprintf(p, "{\"id\": %d, \"price\": %d.5, \"ok\": true, \"name\": \"name-%d\"}", r, r, r);
+            break;
+        case 1:
+            p += sprintf(p, "{\"name\": \"a longer name of row %d\", \"id\": %d, \"price\": %d}", r, r, r);
+            break;
+        case 2:
+            p += sprintf(p, "{\"id\": \"%d\", \"ok\": false, \"price\": null, \"name\": %d}", r, r);
+            break;
+        case 3:
+            p += sprintf(p, (r % 4) ? "%d" : "[%d]", r);
+            break;
+        case 4:
+            p += sprintf(p, "{}");
+            break;
+        case 5:
+            p += sprintf(p, "{\"ok\": true, \"name\": \"\", \"id\": -%d}", r);
+            break;
+        }
+    }
+    *p++ = ']';
+    *p = '\0';
+    return jdata;
+}
+
+
+// Check row `r` of `col` against value `v` of it's record
+static size_t check_row(const Jcsn_Column *col, size_t r, const Jcsn_JValue *v) {
+    const int32_t *off = col->values;
+    Jcsn_JString s;
+    bool valid;
+
+    switch (col->type) {
+    case JCSN_COL_INT64:
+        valid = (v && v->type == J_INTEGER);
+        if (((const int64_t*)col->values)[r] != ((valid) ? v->data.integer : 0))
+            return 1;
+        break;
+    case JCSN_COL_DOUBLE:
+        valid = (v && (v->type == J_INTEGER || v->type == J_REAL));
+        if (((const double*)col->values)[r] != ((!valid) ? 0 : (v->type == J_REAL) ? v->data.real : (double)v->data.integer))
+            return 1;
+        break;
+    case JCSN_COL_BOOL:
+        valid = (v && v->type == J_BOOL);
+        if (BIT(col->values, r) != (valid && v->data.boolean))
+            return 1;
+        break;
+    case JCSN_COL_STRING:
+        valid = (v && v->type == J_STRING);
+        s = (valid) ? jcsn_jval_string(v) : (Jcsn_JString) { .data = "", .len = 0 };
+        if (off[r + 1] - off[r] != (int32_t)s.len || memcmp(col->data + off[r], s.data, s.len) != 0)
+            return 1;
+        break;
+    default:
+        return 1;
+    }
+    return BIT(col->validity, r) != valid;
+}
+
+
+static size_t check_columns(const Jcsn_JValue *arr, Jcsn_Column *cols, size_t n) {
+    const Jcsn_JValue *rec;
+    size_t errors = 0, nulls;
+
+    if (jcsn_extract_columns(arr, cols, n)) {
+        printf("extraction failed\n");
+        return 1;
+    }
+
+    for (size_t c = 0; c < n; c++) {
+        nulls = 0;
+        if (cols[c].len != jcsn_jarr_len(arr)
+            || (cols[c].type == JCSN_COL_STRING && ((const int32_t*)cols[c].values)[0] != 0))
+            errors++;
+        for (size_t r = 0; r < cols[c].len; r++) {
+            rec = jcsn_jarr_get(arr, r);
+            nulls += !BIT(cols[c].validity, r);
+            if (check_row(&cols[c], r, jcsn_jobj_get(rec, cols[c].name, strlen(cols[c].name)))) {
+                if (errors++ < 10)
+                    printf("row %zu of column `%s` is wrong\n", r, cols[c].name);
+            }
+        }
+        if (cols[c].null_count != nulls) {
+            printf("null count of column `%s` is wrong\n", cols[c].name);
+            errors++;
+        }
+    }
+
+    jcsn_columns_free(cols, n);
+    return errors;
+}
+
+
+int main(void) {
+    Jcsn_Column cols[] = {
+        { .name = "id",      .type = JCSN_COL_INT64 },
+        { .name = "id",      .type = JCSN_COL_DOUBLE },
+        { .name = "price",   .type = JCSN_COL_DOUBLE },
+        { .name = "price",   .type = JCSN_COL_INT64 },
+        { .name = "ok",      .type = JCSN_COL_BOOL },
+        { .name = "name",    .type = JCSN_COL_STRING },
+        { .name = "missing", .type = JCSN_COL_STRING },
+    };
+    const size_t n = sizeof(cols) / sizeof(cols[0]);
+    char *jdata = make_document(), empty[] = "{\"e\": [], \"o\": {}}";
+    Jacson *j = (jdata) ? jcsn_parse_json(jdata) : NULL;
+    Jacson *je = jcsn_parse_json(empty);
+    size_t errors = 0;
+
+    if (!j || !je) {
+        printf("parsing failed\n");
+        return 1;
+    }
+
+    errors += check_columns(jcsn_ast_root(j), cols, n);
+    errors += check_columns(jcsn_query_get(je, "e"), cols, n);
+
+    // nothing is left allocated if it's not a json array
+    if (!jcsn_extract_columns(jcsn_query_get(je, "o"), cols, n) || cols[0].validity || cols[0].values) {
+        printf("a json object is extracted\n");
+        errors++;
+    }
+    printf("columns: %zu wrong results\n", errors);
+
+    jcsn_free(je);
+    jcsn_free(j);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <jacson/jacson.h>
+
+// Index test.
+// Every lookup of an index must find what a scan of the json array finds:
+// the first element whose key is a json integer or string equal to it.
+// Keys repeat, some elements have keys of other types, no key or are not
+// json objects at all.
+
+#define ROWS 2000
+
+
+static char *make_document(void) {
+    static const char *others[] = { "true", "null", "{}", "[1]", "1.0" };
+    char *jdata = malloc(ROWS * 64 + 16), *p = jdata;
+    if (!jdata)
+        return NULL;
+
+    *p++ = '[';
+    for (int r = 0; r < ROWS; r++) {
+        if (r)
+            *p++ = ',';
+        switch (r % 8) {
+        case 0:
+        case 1:
+        case 2:
+            p += sprintf(p, "{\"k\": %d, \"r\": %d}", r % 600 - 100, r);
+            break;
+        case 3:
+            p += sprintf(p, "{\"r\": %d, \"k\": \"s%d\"}", r, r % 300);
+            break;
+        case 4:
+            p += sprintf(p, "{\"k\": %d.0, \"r\": %d}", r, r);
+            break;
+        case 5:
+            p += sprintf(p, "{\"k\": %s, \"r\": %d}", others[r % 5], r);
+            break;
+        case 6:
+            p += sprintf(p, "{\"r\": %d}", r);
+            break;
+        case 7:
+            if (r == 7)
+                p += sprintf(p, "{\"k\": 9223372036854775807}");
+            else if (r == 15)
+                p += sprintf(p, "{\"k\": -9223372036854775808}");
+            else if (r == 23)
+                p += sprintf(p, "{\"k\": \"\"}");
+            else if (r == 31)
+                p += sprintf(p, "{\"k\": \"1\"}");
+            else
+                p += sprintf(p, "%d", r);
+            break;
+        }
+    }
+    *p++ = ']';
+    *p = '\0';
+    return jdata;
+}
+
+
+// First element whose key is integer `i` (if `str` is NULL) or string
+// `str` of `len` bytes, by a scan
+static Jcsn_JValue *scan(const Jcsn_JValue *arr, long i, const char *str, size_t len) {
+    Jcsn_JValue *rec, *k;
+    Jcsn_JString s;
+
+    for (size_t r = 0; r < jcsn_jarr_len(arr); r++) {
+        rec = jcsn_jarr_get(arr, r);
+        k = jcsn_jobj_get(rec, "k", 1);
+        if (!k)
+            continue;
+        if (!str && k->type == J_INTEGER && k->data.integer == i)
+            return rec;
+        if (str && k->type == J_STRING) {
+            s = jcsn_jval_string(k);
+            if (s.len == len && memcmp(s.data, str, len) == 0)
+                return rec;
+        }
+    }
+    return NULL;
+}
+
+
+// Scan for key `k` of any type
+static Jcsn_JValue *scan_key(const Jcsn_JValue *arr, const Jcsn_JValue *k) {
+    Jcsn_JString s;
+
+    if (k->type == J_INTEGER)
+        return scan(arr, k->data.integer, NULL, 0);
+    if (k->type == J_STRING) {
+        s = jcsn_jval_string(k);
+        return scan(arr, 0, s.data, s.len);
+    }
+    return NULL;
+}
+
+
+static size_t check_lookups(const Jcsn_JValue *arr, const Jcsn_Index *idx, const Jcsn_JValue *keys) {
+    static const long ints[] = { LONG_MAX, LONG_MIN, LONG_MAX - 1, 1L << 32, -(1L << 32) };
+    static const char *strs[] = { "", "1", "s", "s300", "nope" };
+    const Jcsn_JValue *rec, *k;
+    size_t errors = 0, distinct = 0;
+    char s[16];
+
+    for (long i = -200; i < 700; i++)
+        errors += (jcsn_index_lookup_integer(idx, i) != scan(arr, i, NULL, 0));
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++)
+        errors += (jcsn_index_lookup_integer(idx, ints[i]) != scan(arr, ints[i], NULL, 0));
+
+    for (int i = 0; i < 300; i++) {
+        snprintf(s, sizeof(s), "s%d", i);
+        errors += (jcsn_index_lookup_string(idx, s, strlen(s)) != scan(arr, 0, s, strlen(s)));
+    }
+    for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++)
+        errors += (jcsn_index_lookup_string(idx, strs[i], strlen(strs[i])) != scan(arr, 0, strs[i], strlen(strs[i])));
+
+    // keys of another json document, of every type
+    for (size_t i = 0; i < jcsn_jarr_len(keys); i++) {
+        k = jcsn_jarr_get(keys, i);
+        errors += (jcsn_index_lookup(idx, k) != scan_key(arr, k));
+    }
+
+    // every distinct key once
+    for (size_t r = 0; r < jcsn_jarr_len(arr); r++) {
+        rec = jcsn_jarr_get(arr, r);
+        k = jcsn_jobj_get(rec, "k", 1);
+        distinct += (k && scan_key(arr, k) == rec);
+    }
+    if (jcsn_index_len(idx) != distinct) {
+        printf("index has %zu keys, not %zu\n", jcsn_index_len(idx), distinct);
+        errors++;
+    }
+    return errors;
+}
+
+
+int main(void) {
+    char *jdata = make_document();
+    char keys_jdata[] = "[0, -100, 499, 500, 9223372036854775807, \"s7\", \"\", \"1\", 1,"
+                        " \"nope\", 4.0, true, null, {\"k\": 1}, [1]]";
+    Jacson *j = (jdata) ? jcsn_parse_json(jdata) : NULL;
+    Jacson *keys = jcsn_parse_json(keys_jdata);
+    const Jcsn_JValue *arr;
+    Jcsn_Index *idx;
+    size_t errors = 0;
+
+    if (!j || !keys) {
+        printf("parsing failed\n");
+        return 1;
+    }
+
+    arr = jcsn_ast_root(j);
+    idx = jcsn_index_build(arr, "k");
+    if (!idx) {
+        printf("index build failed\n");
+        return 1;
+    }
+    errors += check_lookups(arr, idx, jcsn_ast_root(keys));
+    jcsn_index_free(idx);
+
+    // no element has member `nope`
+    idx = jcsn_index_build(arr, "nope");
+    if (!idx || jcsn_index_len(idx) != 0 || jcsn_index_lookup_integer(idx, 0))
+        errors++;
+    jcsn_index_free(idx);
+
+    // only json arrays are indexed
+    if (jcsn_index_build(jcsn_jarr_get(jcsn_ast_root(keys), 13), "k") || jcsn_index_lookup_integer(NULL, 1))
+        errors++;
+    printf("index: %zu wrong results\n", errors);
+
+    jcsn_free(keys);
+    jcsn_free(j);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
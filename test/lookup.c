@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jacson/jacson.h>
+
+// Cached member lookup test.
+// `jcsn_jobj_get_cached` must give what `jcsn_jobj_get` gives for every
+// record of a json array, whatever the shapes of records, whichever names
+// are looked up with one cache and whether the member is there or not.
+
+#define JDATA \
+    "[{\"a\": 1, \"b\": 2}, {\"a\": 3, \"b\": 4}, {}, {\"b\": 5}," \
+    " {\"a\": 6, \"b\": 7}, {\"b\": 8, \"a\": 9}, {}, {\"a\": 10}, 11," \
+    " {\"c\": 12}, {\"a\": 13, \"b\": 14}]"
+
+
+static size_t check(const Jcsn_JValue *arr, const char **names, size_t n) {
+    Jcsn_JLookup cache = { 0 };
+    const Jcsn_JValue *rec, *got, *want;
+    size_t errors = 0;
+
+    // same cache for every name, in every order given
+    for (size_t r = 0; r < jcsn_jarr_len(arr); r++) {
+        rec = jcsn_jarr_get(arr, r);
+        for (size_t i = 0; i < n; i++) {
+            got = jcsn_jobj_get_cached(rec, names[i], strlen(names[i]), &cache);
+            want = jcsn_jobj_get(rec, names[i], strlen(names[i]));
+            if (got != want) {
+                printf("`%s` of element %zu is wrong\n", names[i], r);
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+
+int main(void) {
+    static const char *ab[] = { "a", "b" };
+    static const char *ba[] = { "b", "a" };
+    static const char *c[] = { "c", "c" };
+    char *jdata = strdup(JDATA);
+    Jacson *j = jcsn_parse_json(jdata);
+    size_t errors = 0;
+
+    if (!j) {
+        printf("parsing failed\n");
+        return 1;
+    }
+
+    errors += check(jcsn_ast_root(j), ab, 2);
+    errors += check(jcsn_ast_root(j), ba, 2);
+    errors += check(jcsn_ast_root(j), ab, 1);
+    errors += check(jcsn_ast_root(j), c, 2);
+    printf("cached lookups: %zu wrong results\n", errors);
+
+    jcsn_free(j);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <jacson/jacson.h>
+
+// Parser regression test.
+// Integers must be exact up to the limits of `long`, and reals must be
+// bit for bit what `strtod` gives, both inside and just outside the
+// range of the fast path (mantissa up to 2^53, powers of ten up to 22).
+// Surrogate pairs of `\u` escapes must be complete, in both the parser
+// and the validator.
+
+
+typedef struct IntCase {
+    const char *text;
+    long value;
+} IntCase;
+
+typedef struct StrCase {
+    const char *text;
+
+    // Expected bytes, NULL if json string is invalid
+    const char *bytes;
+} StrCase;
+
+
+static const IntCase ints[] = {
+    { "0",                    0 },
+    { "-1",                   -1 },
+    { "9223372036854775807",  LONG_MAX },
+    { "-9223372036854775807", -LONG_MAX },
+    { "-9223372036854775808", LONG_MIN },
+};
+
+// Expected values are `strtod` of the same text
+static const char *reals[] = {
+    // do not fit a long
+    "9223372036854775808", "-9223372036854775809",
+    "18446744073709551616", "123456789012345678901234567890",
+
+    // fast path boundaries
+    "9007199254740992e22", "9007199254740992e-22",
+    "9007199254740993e22", "9007199254740993e-22",
+    "9007199254740992e23", "9007199254740992e-23",
+    "1e22", "1e23", "1e-22", "1e-23",
+    "123e-22", "123e-23", "4.35679e22", "4.35679e-22",
+    "9007199254740.993", "900719925474099.2",
+    "1234567890123456789e3", "1234567890123456789.5",
+    "0.1", "0.3", "-0.0", "2.5e-5", "1.7976931348623157e308",
+
+    // denormals
+    "4.9e-324", "5e-324", "-5e-324",
+    "2.4703282292062328e-324",
+    "2.2250738585072011e-308", "2.2250738585072014e-308",
+    "2.2250738585072012e-308", "1e-310",
+};
+
+static const StrCase strs[] = {
+    { "\"\\u0041\"",             "A" },
+    { "\"\\u00e9\"",             "\xC3\xA9" },
+    { "\"\\u20AC\"",             "\xE2\x82\xAC" },
+    { "\"\\uFFFF\"",             "\xEF\xBF\xBF" },
+    { "\"\\ud83d\\ude00\"",      "\xF0\x9F\x98\x80" },
+    { "\"\\uDBFF\\uDFFF\"",      "\xF4\x8F\xBF\xBF" },
+
+    // lone surrogates
+    { "\"\\ud800\"",             NULL },
+    { "\"\\udbff\"",             NULL },
+    { "\"\\udc00\"",             NULL },
+    { "\"\\udfff\"",             NULL },
+    { "\"\\ud800x\"",            NULL },
+    { "\"\\ud800\\n\"",          NULL },
+
+    // mismatched surrogates
+    { "\"\\ud800\\u0041\"",      NULL },
+    { "\"\\ud800\\ud800\"",      NULL },
+    { "\"\\udc00\\ud800\"",      NULL },
+    { "\"\\ude00\\ud83d\"",      NULL },
+    { "\"\\ud800\\uE000\"",      NULL },
+};
+
+
+// Parse `[text]` and get it's only element (NULL if parsing fails).
+// `*jp` and `*jdata` must be freed by caller.
+static const Jcsn_JValue *parse_one(const char *text, Jacson **jp, char **jdata) {
+    size_t len = strlen(text);
+    *jp = NULL;
+    *jdata = malloc(len + 3);
+    if (!*jdata)
+        return NULL;
+    (*jdata)[0] = '[';
+    memcpy(*jdata + 1, text, len);
+    memcpy(*jdata + 1 + len, "]", 2);
+
+    *jp = jcsn_parse_json(*jdata);
+    return (*jp) ? jcsn_jarr_get(jcsn_ast_root(*jp), 0) : NULL;
+}
+
+
+static size_t check_ints(void) {
+    const Jcsn_JValue *v;
+    Jacson *j;
+    char *jdata;
+    size_t errors = 0;
+
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        v = parse_one(ints[i].text, &j, &jdata);
+        if (!v || v->type != J_INTEGER || v->data.integer != ints[i].value) {
+            printf("integer %s is wrong\n", ints[i].text);
+            errors++;
+        }
+        if (j)
+            jcsn_free(j);
+        free(jdata);
+    }
+    return errors;
+}
+
+
+static size_t check_reals(void) {
+    const Jcsn_JValue *v;
+    Jacson *j;
+    char *jdata;
+    double want;
+    size_t errors = 0;
+
+    for (size_t i = 0; i < sizeof(reals) / sizeof(reals[0]); i++) {
+        want = strtod(reals[i], NULL);
+        v = parse_one(reals[i], &j, &jdata);
+        if (!v || v->type != J_REAL || memcmp(&v->data.real, &want, sizeof(want)) != 0) {
+            printf("real %s is %.17g, not %.17g\n", reals[i], (v) ? v->data.real : 0.0, want);
+            errors++;
+        }
+        if (j)
+            jcsn_free(j);
+        free(jdata);
+    }
+    return errors;
+}
+
+
+static size_t check_strings(void) {
+    const Jcsn_JValue *v;
+    Jcsn_JString s;
+    Jacson *j;
+    char *jdata;
+    const char *want;
+    size_t errors = 0;
+    int ok;
+
+    for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+        want = strs[i].bytes;
+        v = parse_one(strs[i].text, &j, &jdata);
+        if (want) {
+            s = (v && v->type == J_STRING) ? jcsn_jval_string(v) : (Jcsn_JString) { 0 };
+            ok = s.data && s.len == strlen(want) && memcmp(s.data, want, s.len) == 0;
+        } else {
+            ok = (j == NULL);
+        }
+        if (!ok || jcsn_validate_json(jdata, strlen(jdata)) != (want != NULL)) {
+            printf("string %s is %s\n", strs[i].text, (want) ? "rejected or wrong" : "accepted");
+            errors++;
+        }
+        if (j)
+            jcsn_free(j);
+        free(jdata);
+    }
+    return errors;
+}
+
+
+int main(void) {
+    size_t errors = check_ints() + check_reals() + check_strings();
+    printf("parser: %zu wrong results\n", errors);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jacson/jacson.h>
+
+// JSONPath test.
+// Every match of each JSONPath is printed as compact json, one after
+// another, and compared to what RFC 9535 selects, in it's order. Slices
+// cover bounds out of range and negative steps, `..` covers descendant
+// order and filters cover every operator, including members that are
+// missing. Integers beyond +-(2^53 - 1) must not compile.
+
+#define JDATA \
+    "{\"a\": [0, 1, 2, 3, 4, 5, 6, 7, 8, 9]," \
+    " \"o\": {\"x\": {\"a\": 1}, \"a\": 2, \"b\": [{\"a\": 3}]}," \
+    " \"items\": [" \
+    "   {\"n\": \"p\", \"q\": 2, \"price\": 10}," \
+    "   {\"n\": \"q\", \"q\": 0, \"price\": 20.5}," \
+    "   {\"n\": \"r\", \"price\": 30}," \
+    "   {\"n\": \"s\", \"q\": -1, \"price\": true, \"z\": null}]," \
+    " \"e\": []}"
+
+// Matches of a JSONPath, NULL if it must not compile
+typedef struct Case {
+    const char *path;
+    const char *matches;
+} Case;
+
+
+static const Case cases[] = {
+    // names and indices
+    { "$",                          "{\"a\":[0,1,2,3,4,5,6,7,8,9],\"o\":{\"x\":{\"a\":1},\"a\":2,\"b\":[{\"a\":3}]},"
+                                    "\"items\":[{\"n\":\"p\",\"q\":2,\"price\":10},{\"n\":\"q\",\"q\":0,\"price\":20.5},"
+                                    "{\"n\":\"r\",\"price\":30},{\"n\":\"s\",\"q\":-1,\"price\":true,\"z\":null}],\"e\":[]}" },
+    { "$.o.x.a",                    "1" },
+    { "$['o']['a']",                "2" },
+    { "o.a",                        "2" },
+    { "$.nope",                     "" },
+    { "$.a[0]",                     "0" },
+    { "$.a[-1]",                    "9" },
+    { "$.a[-10]",                   "0" },
+    { "$.a[10]",                    "" },
+    { "$.a[-11]",                   "" },
+    { "$.e[0]",                     "" },
+    { "$.o[0]",                     "" },
+    { "$.a.x",                      "" },
+    { "$.o.*",                      "{\"a\":1} 2 [{\"a\":3}]" },
+    { "$.e[*]",                     "" },
+
+    // slices
+    { "$.a[1:4]",                   "1 2 3" },
+    { "$.a[:3]",                    "0 1 2" },
+    { "$.a[7:]",                    "7 8 9" },
+    { "$.a[::3]",                   "0 3 6 9" },
+    { "$.a[-2:]",                   "8 9" },
+    { "$.a[:-8]",                   "0 1" },
+    { "$.a[5:1]",                   "" },
+    { "$.a[1:5:0]",                 "" },
+    { "$.a[2:8:100]",               "2" },
+    { "$.a[-100:100]",              "0 1 2 3 4 5 6 7 8 9" },
+    { "$.a[::-1]",                  "9 8 7 6 5 4 3 2 1 0" },
+    { "$.a[::-3]",                  "9 6 3 0" },
+    { "$.a[8:2:-2]",                "8 6 4" },
+    { "$.a[-1:-4:-1]",              "9 8 7" },
+    { "$.a[1:5:-1]",                "" },
+    { "$.a[100:-100:-1]",           "9 8 7 6 5 4 3 2 1 0" },
+    { "$.a[3:-100:-4]",             "3" },
+    { "$.e[::-1]",                  "" },
+    { "$.o[0:1]",                   "" },
+
+    // integers of I-JSON range only
+    { "$.a[9007199254740991]",      "" },
+    { "$.a[-9007199254740991]",     "" },
+    { "$.a[::9007199254740991]",    "0" },
+    { "$.a[::-9007199254740991]",   "9" },
+    { "$.a[-9007199254740991:9007199254740991:9007199254740991]", "0" },
+    { "$.a[9007199254740992]",      NULL },
+    { "$.a[-9007199254740992]",     NULL },
+    { "$.a[0:9007199254740992]",    NULL },
+    { "$.a[::-9223372036854775808]", NULL },
+    { "$.a[99999999999999999999]",  NULL },
+
+    // descendants, in RFC 9535 order
+    { "$..a",                       "[0,1,2,3,4,5,6,7,8,9] 2 1 3" },
+    { "$.o..a",                     "2 1 3" },
+    { "$..[0]",                     "0 {\"a\":3} {\"n\":\"p\",\"q\":2,\"price\":10}" },
+    { "$.o..*",                     "{\"a\":1} 2 [{\"a\":3}] 1 {\"a\":3} 3" },
+    { "$..z",                       "null" },
+    { "$..nope",                    "" },
+
+    // filters
+    { "$.items[?(@.q == 2)].n",     "\"p\"" },
+    { "$.items[?(@.q != 2)].n",     "\"q\" \"r\" \"s\"" },
+    { "$.items[?(@.q < 1)].n",      "\"q\" \"s\"" },
+    { "$.items[?(@.q <= 0)].n",     "\"q\" \"s\"" },
+    { "$.items[?(@.q > 0)].n",      "\"p\"" },
+    { "$.items[?(@.q >= 0)].n",     "\"p\" \"q\"" },
+    { "$.items[?(@.q)].n",          "\"p\" \"q\" \"s\"" },
+    { "$.items[?(@.price > 15)].n", "\"q\" \"r\"" },
+    { "$.items[?(@.price == 20.5)].n", "\"q\"" },
+    { "$.items[?(@.price == 10.0)].n", "\"p\"" },
+    { "$.items[?(@.price == true)].n", "\"s\"" },
+    { "$.items[?(@.price != true)].n", "\"p\" \"q\" \"r\"" },
+    { "$.items[?(@.z == null)].n",  "\"s\"" },
+    { "$.items[?(@.z != null)].n",  "\"p\" \"q\" \"r\"" },
+    { "$.items[?(@.n == 'r')].price", "30" },
+    { "$.items[?(@.n >= \"q\")].n", "\"q\" \"r\" \"s\"" },
+    { "$.items[?(@.n < 'q')].n",    "\"p\"" },
+    { "$.o[?(@.a)]",                "{\"a\":1}" },
+    { "$..[?(@.a == 3)]",           "{\"a\":3}" },
+
+    // invalid
+    { "$.a[",                       NULL },
+    { "$.a[1:2:3:4]",               NULL },
+    { "$.items[?(@.q === 2)]",      NULL },
+};
+
+
+// Append compact json of `v` to `out` (`len` bytes used, `cap` at most)
+static void print(char *out, size_t *len, size_t cap, const Jcsn_JValue *v) {
+    Jcsn_JString s;
+
+#define PUT(...) (*len += (size_t)((*len < cap) ? snprintf(out + *len, cap - *len, __VA_ARGS__) \
+                                                 : snprintf(NULL, 0, __VA_ARGS__)))
+    switch (v->type) {
+    case J_OBJECT:
+        PUT("{");
+        for (size_t i = 0; i < jcsn_jobj_len(v); i++) {
+            s = jcsn_jobj_name(v, i);
+            PUT("%s\"%.*s\":", (i) ? "," : "", (int)s.len, s.data);
+            print(out, len, cap, jcsn_jobj_value(v, i));
+        }
+        PUT("}");
+        break;
+    case J_ARRAY:
+        PUT("[");
+        for (size_t i = 0; i < jcsn_jarr_len(v); i++) {
+            PUT("%s", (i) ? "," : "");
+            print(out, len, cap, jcsn_jarr_get(v, i));
+        }
+        PUT("]");
+        break;
+    case J_STRING:
+        s = jcsn_jval_string(v);
+        PUT("\"%.*s\"", (int)s.len, s.data);
+        break;
+    case J_INTEGER: PUT("%ld", v->data.integer); break;
+    case J_REAL:    PUT("%g", v->data.real); break;
+    case J_BOOL:    PUT("%s", (v->data.boolean) ? "true" : "false"); break;
+    default:        PUT("null"); break;
+    }
+#undef PUT
+}
+
+
+static void print_sep(char *out, size_t *len, size_t cap) {
+    if (*len + 1 < cap)
+        out[*len] = ' ', out[*len + 1] = '\0';
+    *len += 1;
+}
+
+
+int main(void) {
+    char *jdata = strdup(JDATA), got[1024];
+    Jacson *j = jcsn_parse_json(jdata);
+    Jcsn_PathIter it;
+    Jcsn_Path *path;
+    Jcsn_JValue *v;
+    size_t errors = 0, len;
+
+    if (!j) {
+        printf("parsing failed\n");
+        return 1;
+    }
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        path = jcsn_path_compile(cases[c].path);
+        if (!path || !cases[c].matches) {
+            if (path || cases[c].matches) {
+                printf("%s %s\n", cases[c].path, (path) ? "compiled" : "did not compile");
+                errors++;
+            }
+            jcsn_path_free(path);
+            continue;
+        }
+
+        len = 0;
+        got[0] = '\0';
+        jcsn_path_iter(&it, path, jcsn_ast_root(j));
+        while ((v = jcsn_path_next(&it))) {
+            if (len)
+                print_sep(got, &len, sizeof(got));
+            print(got, &len, sizeof(got), v);
+        }
+        if (len >= sizeof(got) || strcmp(got, cases[c].matches) != 0) {
+            printf("%s gets `%s`, not `%s`\n", cases[c].path, (len < sizeof(got)) ? got : "...", cases[c].matches);
+            errors++;
+        }
+        jcsn_path_free(path);
+    }
+    printf("JSONPath: %zu wrong results\n", errors);
+
+    jcsn_free(j);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jacson/jacson.h>
+
+// Query test.
+// Every query must get the same value from an on-demand document, as a
+// compiled query and as part of a query set (both on the AST and on raw
+// json data) as it gets from the AST with `jcsn_query_get`. Document is
+// bigger than a few windows of on-demand mode, and values are cut by the
+// end of first and second window, so walks must start over there.
+
+// First two windows of on-demand mode are 64 KB and 256 KB
+#define WINDOW_1 (64 * 1024)
+#define WINDOW_2 (256 * 1024)
+
+
+static const char *queries[] = {
+    // found
+    "head", "head.a", "head.s", "head.list", "head.list.[0]", "head.list.[4]",
+    "head.obj.x", "head.obj.y.[0].z", "head.empty", "head.null",
+    // misses
+    "nope", "head.nope", "head.obj.nope", "head.obj.y.[0].nope",
+    // index out of range
+    "head.list.[5]", "head.list.[100]", "head.empty.[0]", "head.obj.y.[1]",
+    // type mismatch
+    "head.a.b", "head.a.[0]", "head.list.x", "head.obj.[0]", "head.s.[0]",
+    // values cut by end of a window
+    "cut1", "cut2",
+    // after every window
+    "tail", "tail.deep.[1].v", "tail.deep.[2]", "tail.last", "tail.nope",
+    // duplicate and empty queries
+    "head.a", "tail.last", "",
+};
+
+
+// Build `{"head": {...}, "pad1": "...", "cut1": 123456789,
+// "pad2": "...", "cut2": "...", "tail": {...}}` with `cut1` and `cut2`
+// across end of first and second window.
+static char *make_document(void) {
+    char *jdata = malloc(WINDOW_2 + 4096), *p = jdata;
+    if (!jdata)
+        return NULL;
+
+    p += sprintf(p, "{\"head\": {\"a\": 1, \"s\": \"str\", \"list\": [10, 11, 12, 13, 14],"
+                    " \"obj\": {\"x\": true, \"y\": [{\"z\": 2.5}]}, \"empty\": [], \"null\": null},"
+                    " \"pad1\": \"");
+    while (p - jdata < WINDOW_1 - 16)
+        *p++ = 'x';
+    p += sprintf(p, "\", \"cut1\": 123456789, \"pad2\": \"");
+    while (p - jdata < WINDOW_2 - 16)
+        *p++ = 'y';
+    p += sprintf(p, "\", \"cut2\": \"cut by second window\","
+                    " \"tail\": {\"deep\": [0, {\"v\": [1, 2]}, \"s\"], \"last\": -1}}");
+    return jdata;
+}
+
+
+static int same(const Jcsn_JValue *a, const Jcsn_JValue *b) {
+    Jcsn_JString sa, sb;
+
+    if (!a || !b)
+        return a == b;
+    if (a->type != b->type)
+        return 0;
+
+    switch (a->type) {
+    case J_OBJECT:
+        if (jcsn_jobj_len(a) != jcsn_jobj_len(b))
+            return 0;
+        for (size_t i = 0; i < jcsn_jobj_len(a); i++) {
+            sa = jcsn_jobj_name(a, i);
+            sb = jcsn_jobj_name(b, i);
+            if (sa.len != sb.len || memcmp(sa.data, sb.data, sa.len) != 0
+                || !same(jcsn_jobj_value(a, i), jcsn_jobj_value(b, i)))
+                return 0;
+        }
+        return 1;
+    case J_ARRAY:
+        if (jcsn_jarr_len(a) != jcsn_jarr_len(b))
+            return 0;
+        for (size_t i = 0; i < jcsn_jarr_len(a); i++)
+            if (!same(jcsn_jarr_get(a, i), jcsn_jarr_get(b, i)))
+                return 0;
+        return 1;
+    case J_STRING:
+        sa = jcsn_jval_string(a);
+        sb = jcsn_jval_string(b);
+        return sa.len == sb.len && memcmp(sa.data, sb.data, sa.len) == 0;
+    case J_INTEGER: return a->data.integer == b->data.integer;
+    case J_REAL:    return a->data.real == b->data.real;
+    case J_BOOL:    return a->data.boolean == b->data.boolean;
+    default:        return 1;
+    }
+}
+
+
+static size_t check(const char *what, const char *query, const Jcsn_JValue *got, const Jcsn_JValue *want) {
+    if (same(got, want))
+        return 0;
+    printf("%s `%s` is wrong (%s)\n", what, query, (got) ? "found" : "not found");
+    return 1;
+}
+
+
+// Run queries as a set on AST and on raw json data
+static size_t check_set(Jacson *ast, Jacson *lazy, const char **qs, size_t n, Jcsn_JValue **want) {
+    Jcsn_JValue *got[sizeof(queries) / sizeof(queries[0])];
+    Jcsn_QuerySet *set = jcsn_query_set_compile(qs, n);
+    size_t errors = 0, found = 0;
+
+    if (!set) {
+        printf("query set of `%s` did not compile\n", qs[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        found += (want[i] != NULL);
+
+    if (jcsn_query_set_exec(set, jcsn_ast_root(ast), got) != found)
+        errors++;
+    for (size_t i = 0; i < n; i++)
+        errors += check("query of set", qs[i], got[i], want[i]);
+
+    if (jcsn_query_get_set(lazy, set, got) != found)
+        errors++;
+    for (size_t i = 0; i < n; i++)
+        errors += check("on-demand query of set", qs[i], got[i], want[i]);
+
+    jcsn_query_set_free(set);
+    return errors;
+}
+
+
+int main(void) {
+    const size_t n = sizeof(queries) / sizeof(queries[0]);
+    char *jdata = make_document();
+    Jacson *ast = (jdata) ? jcsn_parse_json(jdata) : NULL;
+    Jacson *lazy = (jdata) ? jcsn_parse_json_flags(jdata, JCSN_PARSE_ON_DEMAND) : NULL;
+    Jcsn_JValue *want[sizeof(queries) / sizeof(queries[0])];
+    Jcsn_Query *q;
+    size_t errors = 0, found = 0;
+
+    if (!ast || !lazy) {
+        printf("parsing failed\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        want[i] = jcsn_query_get(ast, queries[i]);
+        found += (want[i] != NULL);
+    }
+    if (found != 18) {
+        printf("%zu of %zu queries found on AST\n", found, n);
+        errors++;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        errors += check("on-demand query", queries[i], jcsn_query_get(lazy, queries[i]), want[i]);
+
+    // an empty query does not compile
+    for (size_t i = 0; i < n; i++) {
+        q = jcsn_query_compile(queries[i]);
+        if (!q && *queries[i] == '\0')
+            continue;
+        errors += check("compiled query", queries[i], (q) ? jcsn_query_exec(q, jcsn_ast_root(ast)) : NULL, want[i]);
+        jcsn_query_free(q);
+    }
+
+    // one set of every query, and one of each query alone
+    errors += check_set(ast, lazy, queries, n, want);
+    for (size_t i = 0; i < n; i++)
+        errors += check_set(ast, lazy, &queries[i], 1, &want[i]);
+
+    printf("queries: %zu wrong results\n", errors);
+
+    jcsn_free(lazy);
+    jcsn_free(ast);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <jacson/jacson.h>
+
+// Concurrent readers stress test.
+// One json document is parsed once and queried by many threads at the
+// same time, in every way that builds something lazily: hash indices
+// of json objects (first lookup), values of on-demand queries and the
+// AST of on-demand mode. Run it against a ThreadSanitizer build:
+//   cmake -B build-tsan -DTSAN=ON
+//   cmake --build build-tsan && ctest --test-dir build-tsan
+
+#define THREADS  64
+#define ROUNDS   200
+
+// Document: {"s0": {"s0_f0": 0, ...}, "s1": {...}, ...}. Every section
+// has another shape, so each one gets it's own hash index.
+#define SECTIONS 64
+#define FIELDS   40
+
+
+typedef struct Worker {
+    pthread_t thread;
+    size_t id;
+    Jacson *full;
+    Jacson *lazy;
+    const Jcsn_Query *query;
+    const Jcsn_QuerySet *set;
+    size_t errors;
+} Worker;
+
+
+static char *make_document(void) {
+    char *jdata = malloc(SECTIONS * (FIELDS * 32 + 16) + 3), *p = jdata;
+    assert(jdata != NULL && "malloc returned NULL");
+
+    *p++ = '{';
+    for (size_t s = 0; s < SECTIONS; s++) {
+        p += sprintf(p, "%s\"s%zu\":{", (s) ? "," : "", s);
+        for (size_t f = 0; f < FIELDS; f++)
+            p += sprintf(p, "%s\"s%zu_f%zu\":%zu", (f) ? "," : "", s, f, s * FIELDS + f);
+        *p++ = '}';
+    }
+    *p++ = '}';
+    *p = '\0';
+    return jdata;
+}
+
+
+static void check(Worker *w, const Jcsn_JValue *val, size_t expect) {
+    if (!val || val->type != J_INTEGER || val->data.integer != (long)expect)
+        w->errors += 1;
+}
+
+
+static void *work(void *arg) {
+    Worker *w = arg;
+    char query[64], name[32];
+    const Jcsn_JValue *root = jcsn_ast_root(w->full), *sec;
+    Jcsn_JString interned;
+    Jcsn_JValue *results[2];
+
+    for (size_t r = 0; r < ROUNDS; r++) {
+        // every thread starts at another section, so first lookups of
+        // each section race with each other
+        size_t s = (w->id + r) % SECTIONS, f = (w->id * 7 + r) % FIELDS;
+        size_t expect = s * FIELDS + f;
+
+        snprintf(name, sizeof(name), "s%zu_f%zu", s, f);
+        snprintf(query, sizeof(query), "s%zu.%s", s, name);
+
+        check(w, jcsn_query_get(w->full, query), expect);
+
+        sec = jcsn_jobj_value(root, s);
+        check(w, jcsn_jobj_get(sec, name, strlen(name)), expect);
+
+        interned = jcsn_intern(w->full, name, strlen(name));
+        check(w, jcsn_jobj_get_interned(sec, interned), expect);
+
+        check(w, jcsn_query_exec(w->query, root), 5 * FIELDS + 3);
+
+        jcsn_query_set_exec(w->set, root, results);
+        check(w, results[0], 5 * FIELDS + 3);
+        check(w, results[1], 9 * FIELDS + 1);
+
+        // on-demand handle: each query keeps it's value in the handle
+        if (r % 16 == 0)
+            check(w, jcsn_query_get(w->lazy, query), expect);
+        if (r % 64 == 0)
+            check(w, jcsn_jobj_get(jcsn_jobj_value(jcsn_ast_root(w->lazy), s), name, strlen(name)), expect);
+        if (r % 32 == 0) {
+            jcsn_query_get_set(w->lazy, w->set, results);
+            check(w, results[1], 9 * FIELDS + 1);
+        }
+    }
+    return NULL;
+}
+
+
+int main(void) {
+    char *jdata = make_document();
+    Jacson *full = jcsn_parse_json(jdata);
+    Jacson *lazy = jcsn_parse_json_flags(jdata, JCSN_PARSE_ON_DEMAND);
+    Jcsn_Query *query = jcsn_query_compile("s5.s5_f3");
+    const char *paths[] = { "s5.s5_f3", "s9.s9_f1" };
+    Jcsn_QuerySet *set = jcsn_query_set_compile(paths, 2);
+    assert(full && lazy && query && set && "parsing failed");
+
+    Worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        workers[i] = (Worker) {
+            .id = i,
+            .full = full,
+            .lazy = lazy,
+            .query = query,
+            .set = set,
+            .errors = 0,
+        };
+        if (pthread_create(&workers[i].thread, NULL, work, &workers[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+
+    size_t errors = 0;
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_join(workers[i].thread, NULL);
+        errors += workers[i].errors;
+    }
+
+    printf("%d threads, %d rounds each: %zu wrong results\n", THREADS, ROUNDS, errors);
+
+    jcsn_query_set_free(set);
+    jcsn_query_free(query);
+    jcsn_free(lazy);
+    jcsn_free(full);
+    free(jdata);
+    return (errors) ? 1 : 0;
+}
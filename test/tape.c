@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jacson/jacson.h>
+
+// Tape test.
+// Every document is parsed once as a tape and once as an AST, and tape is
+// walked with `jcsn_tape_child`/`jcsn_tape_next` alongside the AST: types,
+// member names, values and number of children must all agree, and
+// `jcsn_tape_skip` of a value must be it's next sibling. Getters must be
+// safe on `JCSN_TAPE_NONE` and on values of another type.
+
+static const char *documents[] = {
+    "{\"a\": 1, \"s\": \"str\", \"esc\": \"q\\\"\\\\\\n\\u00e9\", \"r\": -2.5e3,"
+    " \"t\": true, \"f\": false, \"n\": null, \"list\": [1, [2, [3, []]], {}],"
+    " \"obj\": {\"x\": {\"y\": {\"z\": [\"\"]}}}, \"empty\": {}, \"last\": [0]}",
+    "[9223372036854775807, -9223372036854775808, 0.0, \"\", [], {}, [[[]]]]",
+    "\"a string\"",
+    "42",
+    "null",
+    "[]",
+};
+
+
+// Sibling of `idx` on tape, which must be right after it's children
+static size_t next(const Jcsn_Tape *t, size_t idx, size_t *errors) {
+    size_t kid = jcsn_tape_next(t, idx);
+    *errors += (kid != JCSN_TAPE_NONE && kid != jcsn_tape_skip(t, idx));
+    return kid;
+}
+
+
+// Compare value at `idx` of tape `t` to `v`
+static size_t check(const Jcsn_Tape *t, size_t idx, const Jcsn_JValue *v) {
+    Jcsn_JString s, sv;
+    size_t errors = 0, n = 0, kid, len = 0;
+    const char *str;
+
+    if (jcsn_tape_type(t, idx) != v->type)
+        return 1;
+
+    switch (v->type) {
+    case J_OBJECT:
+        for (kid = jcsn_tape_child(t, idx); kid != JCSN_TAPE_NONE; kid = next(t, kid, &errors)) {
+            if (n >= jcsn_jobj_len(v))
+                return errors + 1;
+            // member name, followed by it's value
+            s = jcsn_jobj_name(v, n);
+            str = jcsn_tape_string(t, kid, &len);
+            if (!str || len != s.len || memcmp(str, s.data, len) != 0)
+                errors++;
+            kid = next(t, kid, &errors);
+            if (kid == JCSN_TAPE_NONE)
+                return errors + 1;
+            errors += check(t, kid, jcsn_jobj_value(v, n++));
+        }
+        errors += (n != jcsn_jobj_len(v));
+        break;
+    case J_ARRAY:
+        for (kid = jcsn_tape_child(t, idx); kid != JCSN_TAPE_NONE; kid = next(t, kid, &errors)) {
+            if (n >= jcsn_jarr_len(v))
+                return errors + 1;
+            errors += check(t, kid, jcsn_jarr_get(v, n++));
+        }
+        errors += (n != jcsn_jarr_len(v));
+        break;
+    case J_STRING:
+        sv = jcsn_jval_string(v);
+        str = jcsn_tape_string(t, idx, &len);
+        errors += (!str || len != sv.len || memcmp(str, sv.data, len) != 0 || str[len] != '\0');
+        break;
+    case J_INTEGER:
+        errors += (jcsn_tape_integer(t, idx) != v->data.integer);
+        break;
+    case J_REAL:
+        errors += (jcsn_tape_real(t, idx) != v->data.real);
+        break;
+    case J_BOOL:
+        errors += (jcsn_tape_bool(t, idx) != v->data.boolean);
+        break;
+    default:
+        break;
+    }
+
+    // scalars have no children, and only strings are strings
+    if (v->type != J_OBJECT && v->type != J_ARRAY)
+        errors += (jcsn_tape_child(t, idx) != JCSN_TAPE_NONE);
+    if (v->type != J_STRING)
+        errors += (jcsn_tape_string(t, idx, NULL) != NULL);
+    return errors;
+}
+
+
+// Getters of `JCSN_TAPE_NONE`
+static size_t check_none(const Jcsn_Tape *t) {
+    const size_t none = JCSN_TAPE_NONE;
+    size_t len = 7;
+
+    return (jcsn_tape_type(t, none) != J_NULL)
+           + (jcsn_tape_child(t, none) != JCSN_TAPE_NONE)
+           + (jcsn_tape_next(t, none) != JCSN_TAPE_NONE)
+           + (jcsn_tape_skip(t, none) != JCSN_TAPE_NONE)
+           + (jcsn_tape_string(t, none, &len) != NULL || len != 7)
+           + (jcsn_tape_integer(t, none) != 0)
+           + (jcsn_tape_real(t, none) != 0.0)
+           + (jcsn_tape_bool(t, none) != false);
+}
+
+
+int main(void) {
+    const size_t n = sizeof(documents) / sizeof(documents[0]);
+    char *tdata, *adata;
+    Jacson *tj, *aj;
+    const Jcsn_Tape *t;
+    size_t errors = 0, root;
+
+    for (size_t d = 0; d < n; d++) {
+        tdata = strdup(documents[d]);
+        adata = strdup(documents[d]);
+        tj = jcsn_parse_json_flags(tdata, JCSN_PARSE_TAPE);
+        aj = jcsn_parse_json(adata);
+        if (!tj || !aj) {
+            printf("parsing of document %zu failed\n", d);
+            return 1;
+        }
+
+        t = jcsn_tape(tj);
+        if (!t || jcsn_tape(aj) || jcsn_ast_root(tj)) {
+            printf("document %zu: wrong representation\n", d);
+            errors++;
+        } else {
+            root = jcsn_tape_root(t);
+            if (check(t, root, jcsn_ast_root(aj))
+                || jcsn_tape_next(t, root) != JCSN_TAPE_NONE
+                || jcsn_tape_type(t, jcsn_tape_skip(t, root)) != J_NULL)
+            {
+                printf("document %zu: tape differs from AST\n", d);
+                errors++;
+            }
+            errors += check_none(t);
+        }
+
+        jcsn_free(aj);
+        jcsn_free(tj);
+        free(adata);
+        free(tdata);
+    }
+    printf("tape: %zu wrong results\n", errors);
+    return (errors) ? 1 : 0;
+}
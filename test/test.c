@@ -49,9 +49,11 @@ int main(int argc, char *argv[]) {
             printf("%lf\n", result->data.real);
             break;
 
-        case J_STRING:
-            printf("%s\n", result->data.string);
-            break;
+        case J_STRING: {
+            Jcsn_JString s = jcsn_jval_string(result);
+            printf("%.*s\n", (int)s.len, s.data);
+        }
+        break;
 
         case J_NULL:
             printf("null\n");
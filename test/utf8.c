@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scan.h"
+
+// Utf-8 validation regression test.
+// `jcsn_utf8_valid` has a SSSE3 path and a scalar path, chosen at compile
+// time. This program is built once for each of them (See CMakeLists.txt)
+// and checks known sequences at every offset around 16 byte blocks, then
+// compares random sequences against a plain decoder.
+
+#if defined(__SSSE3__)
+    #define PATH "ssse3"
+#else
+    #define PATH "scalar"
+#endif
+
+#define RANDOM_ROUNDS 200000
+
+
+typedef struct Case {
+    const char *name;
+    const char *bytes;
+    int valid;
+} Case;
+
+static const Case cases[] = {
+    { "ascii",                "a",                    1 },
+    { "2 byte min",           "\xC2\x80",             1 },
+    { "2 byte max",           "\xDF\xBF",             1 },
+    { "3 byte min",           "\xE0\xA0\x80",         1 },
+    { "before surrogates",    "\xED\x9F\xBF",         1 },
+    { "after surrogates",     "\xEE\x80\x80",         1 },
+    { "3 byte max",           "\xEF\xBF\xBF",         1 },
+    { "4 byte min",           "\xF0\x90\x80\x80",     1 },
+    { "U+10FFFF",             "\xF4\x8F\xBF\xBF",     1 },
+    { "mixed",                "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80z", 1 },
+
+    { "overlong 2 byte C0",   "\xC0\x80",             0 },
+    { "overlong 2 byte C1",   "\xC1\xBF",             0 },
+    { "overlong 3 byte",      "\xE0\x80\x80",         0 },
+    { "overlong 3 byte max",  "\xE0\x9F\xBF",         0 },
+    { "overlong 4 byte",      "\xF0\x80\x80\x80",     0 },
+    { "overlong 4 byte max",  "\xF0\x8F\xBF\xBF",     0 },
+
+    { "surrogate D800",       "\xED\xA0\x80",         0 },
+    { "surrogate DFFF",       "\xED\xBF\xBF",         0 },
+    { "surrogate pair",       "\xED\xA0\xBD\xED\xB8\x80", 0 },
+
+    { "U+110000",             "\xF4\x90\x80\x80",     0 },
+    { "F5 lead",              "\xF5\x80\x80\x80",     0 },
+    { "F7 lead",              "\xF7\xBF\xBF\xBF",     0 },
+    { "5 byte lead",          "\xF8\x88\x80\x80\x80", 0 },
+    { "FF byte",              "\xFF",                 0 },
+
+    { "truncated 2 byte",     "\xC2",                 0 },
+    { "truncated 3 byte",     "\xE0\xA0",             0 },
+    { "truncated 3 byte (1)", "\xE1",                 0 },
+    { "truncated 4 byte",     "\xF0\x90\x80",         0 },
+    { "truncated 4 byte (2)", "\xF3\x80",             0 },
+    { "lone continuation",    "\x80",                 0 },
+    { "lone continuation BF", "\xBF",                 0 },
+    { "too many continuations", "\xC2\x80\x80",       0 },
+    { "ascii in sequence",    "\xE1\x80" "a",         0 },
+};
+
+
+// Decode one code point at a time and check it's range
+static int reference_valid(const unsigned char *s, size_t len) {
+    static const unsigned long min[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    size_t i = 0;
+    unsigned long cp;
+    int n;
+
+    while (i < len) {
+        if (s[i] < 0x80)
+            n = 1, cp = s[i];
+        else if ((s[i] & 0xE0) == 0xC0)
+            n = 2, cp = s[i] & 0x1F;
+        else if ((s[i] & 0xF0) == 0xE0)
+            n = 3, cp = s[i] & 0x0F;
+        else if ((s[i] & 0xF8) == 0xF0)
+            n = 4, cp = s[i] & 0x07;
+        else
+            return 0;
+
+        if (len - i < (size_t)n)
+            return 0;
+        for (int k = 1; k < n; k++) {
+            if ((s[i + k] & 0xC0) != 0x80)
+                return 0;
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if (cp < min[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+            return 0;
+        i += n;
+    }
+    return 1;
+}
+
+
+static size_t check_cases(void) {
+    char buf[128];
+    size_t errors = 0, len;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        len = strlen(cases[c].bytes);
+        // every position of sequence in and across 16 byte blocks, with
+        // and without ascii after it
+        for (size_t pre = 0; pre < 48; pre++) {
+            for (size_t post = 0; post < 18; post++) {
+                memset(buf, 'a', pre);
+                memcpy(buf + pre, cases[c].bytes, len);
+                memset(buf + pre + len, 'z', post);
+                if (jcsn_utf8_valid(buf, pre + len + post) != cases[c].valid) {
+                    if (errors++ < 10)
+                        printf("%s: `%s` at offset %zu (+%zu) is wrong\n", PATH, cases[c].name, pre, post);
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+
+static size_t check_random(void) {
+    // bytes that start, continue or break sequences
+    static const unsigned char pool[] = {
+        'a', 'z', 0x00, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xE1, 0xED, 0xEE, 0xEF,
+        0xF0, 0xF1, 0xF4, 0xF5, 0xFF,
+    };
+    unsigned char buf[80];
+    size_t errors = 0, len;
+    unsigned long seed = 12345;
+
+    for (size_t r = 0; r < RANDOM_ROUNDS; r++) {
+        len = r % sizeof(buf);
+        for (size_t i = 0; i < len; i++) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            buf[i] = pool[(seed >> 33) % sizeof(pool)];
+        }
+        if (jcsn_utf8_valid((const char*)buf, len) != reference_valid(buf, len)) {
+            if (errors++ < 10)
+                printf("%s: random sequence %zu (%zu bytes) is wrong\n", PATH, r, len);
+        }
+    }
+    return errors;
+}
+
+
+int main(void) {
+    size_t errors = check_cases() + check_random();
+    printf("%s utf-8 validation: %zu wrong results\n", PATH, errors);
+    return (errors) ? 1 : 0;
+}